@@ -0,0 +1,215 @@
+/** @file
+ * Stress test of the swept collision of the ball (collision.c) on random trajectories. \n
+ * Every trajectory starts at a random place outside the paddles with a random velocity of up to the given speed
+ * (many court widths per update) and random paddle positions, a part of them grazes the edges of a paddle. \n
+ * The path of the ball (the start, the contacts and the end) is checked independently in floating point:
+ * no step may go through a paddle and the ball may never leave the court. \n
+ * Prints one CSV line with the numbers of trajectories, contacts, truncated paths and violations
+ * and the nanoseconds per swept update, exits with 1 if any violation was found. \n
+ * Usage: bench_collision [-n trajectories] [-v max speed in pixels per update] [-s seed]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "collision.h"
+#include "game.h"
+#include "graphics.h"
+
+#define DEFAULT_TRAJECTORIES 4000000
+#define DEFAULT_MAX_SPEED 2000
+#define SPEED_LIMIT 10000
+// tolerance of the checks in pixels, a few units of the last place of fixed_t
+#define EPSILON (1.0 / 256)
+#define MAX_REPORTED 10
+#define BATCH_SIZE 1024
+
+/**
+ * A trajectory and its swept result.
+ */
+struct trajectory {
+    int paddle_y[2];
+    fixed_t x, y, vel_x, vel_y;
+    fixed_t end_x, end_y;
+    int count;
+    struct contact contacts[MAX_CONTACTS];
+};
+
+static unsigned long long rng_state;
+
+static unsigned int next_random(void) {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (unsigned int)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+static int random_range(int low, int high) {
+    return low + (int)(next_random() % (unsigned int)(high - low + 1));
+}
+
+static long long now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+static double to_pixels(fixed_t f) {
+    return (double)f / FIXED_ONE;
+}
+
+/**
+ * Whether the point of the ball lies in the open region where the ball overlaps the paddle.
+ */
+static char inside_paddle(double x, double y, int side, int paddle_y) {
+    double left = side ? LCD_WIDTH - PADDLE_WIDTH - BALL_SIZE : -BALL_SIZE;
+    double right = side ? LCD_WIDTH : PADDLE_WIDTH;
+    return x > left && x < right && y > paddle_y - BALL_SIZE && y < paddle_y + PADDLE_HEIGHT;
+}
+
+/**
+ * Whether the segment from (ax, ay) to (bx, by) goes through the open region of the paddle (slab test).
+ */
+static char segment_hits_paddle(double ax, double ay, double bx, double by, int side, int paddle_y) {
+    double low[2] = {side ? LCD_WIDTH - PADDLE_WIDTH - BALL_SIZE : -BALL_SIZE, paddle_y - BALL_SIZE};
+    double high[2] = {side ? LCD_WIDTH : PADDLE_WIDTH, paddle_y + PADDLE_HEIGHT};
+    double from[2] = {ax, ay}, delta[2] = {bx - ax, by - ay};
+    double t_in = 0, t_out = 1;
+    for (int axis = 0; axis < 2; axis++) {
+        double lo = low[axis] + EPSILON, hi = high[axis] - EPSILON;
+        if (delta[axis] == 0) {
+            if (from[axis] <= lo || from[axis] >= hi) return 0;
+            continue;
+        }
+        double t0 = (lo - from[axis]) / delta[axis], t1 = (hi - from[axis]) / delta[axis];
+        if (t0 > t1) {
+            double swap = t0;
+            t0 = t1;
+            t1 = swap;
+        }
+        if (t0 > t_in) t_in = t0;
+        if (t1 < t_out) t_out = t1;
+        if (t_in >= t_out) return 0;
+    }
+    return 1;
+}
+
+static char inside_court(double x, double y) {
+    return x >= -EPSILON && x <= LCD_WIDTH - BALL_SIZE + EPSILON && y >= LIVES_FONT_SIZE - EPSILON && y <= LCD_HEIGHT - BALL_SIZE + EPSILON;
+}
+
+/**
+ * Generate a random trajectory starting outside the paddles.
+ */
+static void random_trajectory(struct trajectory* tr, int max_speed) {
+    tr->paddle_y[0] = random_range(LIVES_FONT_SIZE, LCD_HEIGHT - PADDLE_HEIGHT);
+    tr->paddle_y[1] = random_range(LIVES_FONT_SIZE, LCD_HEIGHT - PADDLE_HEIGHT);
+    do {
+        tr->x = random_range(0, INT_TO_FIXED(LCD_WIDTH - BALL_SIZE));
+        tr->y = random_range(INT_TO_FIXED(LIVES_FONT_SIZE), INT_TO_FIXED(LCD_HEIGHT - BALL_SIZE));
+        // every eighth trajectory starts on the line of a paddle edge to graze it
+        if (next_random() % 8 == 0) {
+            int side = next_random() % 2;
+            int edge_y = next_random() % 2 ? tr->paddle_y[side] - BALL_SIZE : tr->paddle_y[side] + PADDLE_HEIGHT;
+            if (edge_y >= LIVES_FONT_SIZE && edge_y <= LCD_HEIGHT - BALL_SIZE) tr->y = INT_TO_FIXED(edge_y);
+        }
+    } while (inside_paddle(to_pixels(tr->x), to_pixels(tr->y), 0, tr->paddle_y[0])
+             || inside_paddle(to_pixels(tr->x), to_pixels(tr->y), 1, tr->paddle_y[1]));
+    // speeds of all magnitudes, from a fraction of a pixel to max_speed pixels per update
+    int scale = next_random() % 12;
+    fixed_t max_vel = INT_TO_FIXED(max_speed) >> scale;
+    if (max_vel < 1) max_vel = 1;
+    tr->vel_x = random_range(-max_vel, max_vel);
+    tr->vel_y = next_random() % 8 == 0 ? 0 : random_range(-max_vel, max_vel);
+}
+
+/**
+ * Check the path of a swept trajectory.
+ * @return NULL if the path is valid, description of the violation otherwise
+ */
+static char* check_trajectory(struct trajectory* tr) {
+    double ax = to_pixels(tr->x), ay = to_pixels(tr->y);
+    for (int i = 0; i <= tr->count; i++) {
+        double bx = i < tr->count ? to_pixels(tr->contacts[i].x) : to_pixels(tr->end_x);
+        double by = i < tr->count ? to_pixels(tr->contacts[i].y) : to_pixels(tr->end_y);
+        if (!inside_court(bx, by)) return "the ball left the court";
+        for (int side = 0; side < 2; side++) {
+            if (segment_hits_paddle(ax, ay, bx, by, side, tr->paddle_y[side])) return "the ball went through a paddle";
+        }
+        ax = bx;
+        ay = by;
+    }
+    if (tr->count && tr->contacts[tr->count - 1].surface == SURFACE_GOAL
+        && (tr->end_x != tr->contacts[tr->count - 1].x || tr->end_y != tr->contacts[tr->count - 1].y)) {
+        return "the ball moved after a goal";
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    long trajectories = DEFAULT_TRAJECTORIES;
+    int max_speed = DEFAULT_MAX_SPEED;
+    unsigned long long seed = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:v:s:")) != -1) {
+        switch (opt) {
+            case 'n':
+                trajectories = atol(optarg);
+                break;
+            case 'v':
+                max_speed = atoi(optarg);
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n trajectories] [-v max speed] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (trajectories < 1 || max_speed < 1 || max_speed > SPEED_LIMIT) {
+        fprintf(stderr, "trajectories must be positive and the speed within 1 and %d\n", SPEED_LIMIT);
+        return 1;
+    }
+    rng_state = seed * 0x9e3779b97f4a7c15ULL + 1;
+
+    // the trajectories are swept in batches, so the clock is read only twice per batch
+    static struct trajectory batch[BATCH_SIZE];
+    long contacts = 0, truncated = 0, violations = 0;
+    long long sweep_ns = 0;
+    for (long done = 0; done < trajectories; done += BATCH_SIZE) {
+        int size = trajectories - done < BATCH_SIZE ? trajectories - done : BATCH_SIZE;
+        for (int i = 0; i < size; i++) random_trajectory(&batch[i], max_speed);
+        long long start = now_ns();
+        for (int i = 0; i < size; i++) {
+            struct trajectory* tr = &batch[i];
+            fixed_t vel_x = tr->vel_x, vel_y = tr->vel_y;
+            tr->end_x = tr->x;
+            tr->end_y = tr->y;
+            tr->count = sweep_ball(&tr->end_x, &tr->end_y, &vel_x, &vel_y, tr->paddle_y, BALL_SPEED_HARD, tr->contacts);
+        }
+        sweep_ns += now_ns() - start;
+        for (int i = 0; i < size; i++) {
+            struct trajectory* tr = &batch[i];
+            contacts += tr->count;
+            if (tr->count == MAX_CONTACTS) truncated++;
+            char* violation = check_trajectory(tr);
+            if (!violation) continue;
+            if (violations < MAX_REPORTED) {
+                fprintf(stderr, "%s: start %.4f %.4f velocity %.4f %.4f paddles %d %d end %.4f %.4f contacts %d\n", violation,
+                        to_pixels(tr->x), to_pixels(tr->y), to_pixels(tr->vel_x), to_pixels(tr->vel_y), tr->paddle_y[0], tr->paddle_y[1],
+                        to_pixels(tr->end_x), to_pixels(tr->end_y), tr->count);
+            }
+            violations++;
+        }
+    }
+
+    printf("trajectories,max_speed,contacts,truncated,violations,ns_per_sweep\n");
+    printf("%ld,%d,%ld,%ld,%ld,%.1f\n", trajectories, max_speed, contacts, truncated, violations, (double)sweep_ns / trajectories);
+    return violations ? 1 : 0;
+}
@@ -0,0 +1,318 @@
+/** @file
+ * Measures the hot paths of the game: game update, view update, text and menu drawing and the AIs. \n
+ * A menu step is measured incrementally, only the changed rows are drawn and sent, and with the whole menu drawn and sent. \n
+ * The game and view updates of the multi-ball mode are measured for several numbers of balls. \n
+ * The lcd registers are replaced by mmio_count.c and the led registers by plain memory,
+ * so the benchmark runs on a host computer as well as on the board. \n
+ * Every hot path runs for a fixed number of iterations split into samples, the results are printed
+ * to stdout as CSV: nanoseconds per operation (mean, percentiles of the samples) and lcd bus writes per operation. \n
+ * Usage: bench_hot_paths [-n iterations] [-s samples]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mzapo_regs.h"
+#include "font_types.h"
+#include "graphics.h"
+#include "text.h"
+#include "menu.h"
+#include "settings.h"
+#include "peripherals.h"
+#include "game.h"
+#include "game_view.h"
+#include "ai_registry.h"
+#include "policy_ai.h"
+#include "mmio_count.h"
+
+#define DEFAULT_ITERATIONS 100000
+#define DEFAULT_SAMPLES 100
+#define STATE_COUNT 4096
+#define MULTI_STATE_COUNT 256
+
+/**
+ * Results of one hot path.
+ */
+typedef struct bench_result {
+    char* name;
+    long iterations;
+    double mean, p50, p90, p99, min, max;
+    double cmd_writes, data_writes, data2x_writes;
+} bench_result_t;
+
+typedef void (*bench_fn)(long i);
+
+static FILE* results;
+static uint16_t frame[LCD_WIDTH * LCD_HEIGHT];
+static struct game_data states[STATE_COUNT];
+static int scores[STATE_COUNT];
+static game_ctx_t game;
+static struct tick_input no_input;
+static settings_t* game_settings;
+static unsigned char* game_membase;
+static settings_t multi_settings;
+static game_ctx_t multi_game;
+static struct game_data multi_data[MULTI_STATE_COUNT];
+static struct balls multi_balls[MULTI_STATE_COUNT];
+static int multi_ball_counts[] = {1, 8, MULTI_BALL_COUNT, MAX_BALLS};
+static const ai_interface_t* bench_ai;
+static const ai_interface_t* bench_expert_ai;
+static const ai_interface_t* bench_policy_ai;
+static const ai_interface_t* bench_human_ai;
+static struct ai_state human_ai_states[2];
+static struct ai_state ai_states[2];
+static struct ai_state expert_ai_states[2];
+static unsigned int ai_seed = 1;
+static menu_ctx_t menu_ctx;
+static char* menu_labels[MAIN_MENU_ITEMS] = {"PLAY", "SCORES", "SETTINGS", "QUIT"};
+/* scrolling down and up through the whole main menu */
+static int menu_steps[] = {0, 1, 2, 3, 2, 1};
+static volatile char sink;
+
+static long long now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile(double* sorted, int count, int p) {
+    int index = (count - 1) * p / 100;
+    return sorted[index];
+}
+
+/**
+ * Run fn for the given number of iterations split into samples and fill the result.
+ */
+static void run_bench(bench_result_t* result, char* name, bench_fn fn, long iterations, int samples) {
+    double* per_op = malloc(samples * sizeof(double));
+    if (!per_op) {
+        fprintf(stderr, "allocation error\n");
+        exit(1);
+    }
+    long per_sample = iterations / samples > 0 ? iterations / samples : 1;
+    long i = 0;
+    double sum = 0;
+    reset_mmio_counts();
+    for (int s = 0; s < samples; s++) {
+        long long start = now_ns();
+        for (long k = 0; k < per_sample; k++, i++) fn(i);
+        per_op[s] = (double)(now_ns() - start) / per_sample;
+        sum += per_op[s];
+    }
+    qsort(per_op, samples, sizeof(double), compare_doubles);
+    result->name = name;
+    result->iterations = i;
+    result->mean = sum / samples;
+    result->p50 = percentile(per_op, samples, 50);
+    result->p90 = percentile(per_op, samples, 90);
+    result->p99 = percentile(per_op, samples, 99);
+    result->min = per_op[0];
+    result->max = per_op[samples - 1];
+    result->cmd_writes = (double)mmio_counts.cmd_writes / i;
+    result->data_writes = (double)mmio_counts.data_writes / i;
+    result->data2x_writes = (double)mmio_counts.data2x_writes / i;
+    free(per_op);
+}
+
+static void print_result(bench_result_t* r) {
+    fprintf(results, "%s,%ld,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.2f,%.2f,%.2f\n", r->name, r->iterations,
+            r->mean, r->p50, r->p90, r->p99, r->min, r->max, r->cmd_writes, r->data_writes, r->data2x_writes);
+    fflush(results);
+}
+
+static void restart_game(game_ctx_t* ctx, settings_t* settings, long seed) {
+    destroy_game_ctx(ctx);
+    init_game_ctx(ctx, settings, game_membase, seed);
+}
+
+/* a finished game starts again, so every iteration runs a real update */
+static void bench_update(long i) {
+    sink = update(&game, no_input);
+    if (!sink) restart_game(&game, game_settings, i);
+}
+
+static void bench_update_view(long i) {
+    update_view(states[i % STATE_COUNT], NULL, scores[i % STATE_COUNT]);
+}
+
+static void bench_update_multi(long i) {
+    sink = update(&multi_game, no_input);
+    if (!sink) restart_game(&multi_game, &multi_settings, i);
+}
+
+static void bench_update_view_multi(long i) {
+    update_view(multi_data[i % MULTI_STATE_COUNT], &multi_balls[i % MULTI_STATE_COUNT], -1);
+}
+
+static void bench_put_string(long i) {
+    put_string(MSG_X, (i % 3) * 100, frame, &font_wArial_88, menu_labels[i % MAIN_MENU_ITEMS], WHITE, BLACK);
+}
+
+static void bench_fill_menu(long i) {
+    fill_menu(&root_menu, i % MAIN_MENU_ITEMS, &menu_ctx);
+}
+
+static void bench_menu_step(long i) {
+    fill_menu(&root_menu, menu_steps[i % 6], &menu_ctx);
+    show_menu(frame, NULL);
+}
+
+static void bench_menu_step_full(long i) {
+    reset_menu_rows();
+    fill_menu(&root_menu, menu_steps[i % 6], &menu_ctx);
+    show_menu(frame, NULL);
+}
+
+/* the color of the ball is changed in the settings menu, only the square of the color is sent */
+static void bench_color_step(long i) {
+    game_settings->ballcolor = i & 1 ? RED : BLUE;
+    fill_menu(&settings_menu, BALL_COLOR, &menu_ctx);
+    show_menu(frame, NULL);
+}
+
+static void bench_better_ai_move(long i) {
+    sink = bench_ai->move(i & 1, states[i % STATE_COUNT], &ai_states[i & 1], &ai_seed);
+}
+
+static void bench_expert_ai_move(long i) {
+    sink = bench_expert_ai->move(i & 1, states[i % STATE_COUNT], &expert_ai_states[i & 1], &ai_seed);
+}
+
+/* the table lookup of the learned AI, the policy file is taken from the working directory */
+static void bench_policy_ai_move(long i) {
+    sink = bench_policy_ai->move(i & 1, states[i % STATE_COUNT], &ai_states[i & 1], &ai_seed);
+}
+
+static void bench_human_ai_move(long i) {
+    sink = bench_human_ai->move(i & 1, states[i % STATE_COUNT], &human_ai_states[i & 1], &ai_seed);
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = DEFAULT_ITERATIONS;
+    int samples = DEFAULT_SAMPLES;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+            case 'n':
+                iterations = atol(optarg);
+                break;
+            case 's':
+                samples = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n iterations] [-s samples]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (iterations < 1 || samples < 1) {
+        fprintf(stderr, "iterations and samples must be positive\n");
+        return 1;
+    }
+    if (samples > iterations) samples = iterations;
+
+    /* results go to the original stdout, the logs of the game are discarded and the game reads no keys */
+    results = fdopen(dup(STDOUT_FILENO), "w");
+    if (!results || !freopen("/dev/null", "w", stdout) || !freopen("/dev/null", "r", stdin)) {
+        fprintf(stderr, "cannot redirect standard streams\n");
+        return 1;
+    }
+
+    unsigned char* membase = calloc(SPILED_REG_SIZE, 1);
+    if (!membase) {
+        fprintf(stderr, "allocation error\n");
+        return 1;
+    }
+    settings_t* settings = init_settings();
+    settings->left = BOT;
+    settings->right = BOT;
+    settings->ai = SMARTER_AI;
+    settings->difficulty = HARD;
+    game_settings = settings;
+    game_membase = membase;
+    bench_ai = get_ai(SMARTER_AI);
+    bench_expert_ai = get_ai(EXPERT_AI);
+    bench_policy_ai = get_ai(POLICY_AI);
+    bench_human_ai = get_ai(HUMAN_AI);
+    bench_human_ai->init(&human_ai_states[0], 0);
+    bench_human_ai->init(&human_ai_states[1], 1);
+    if (load_policy(POLICY_FILE)) fprintf(stderr, "no %s, policy_ai_move follows the ball\n", POLICY_FILE);
+
+    init_game_ctx(&game, settings, membase, 1);
+    for (int i = 0; i < STATE_COUNT; i++) {
+        if (!update(&game, no_input)) restart_game(&game, settings, i);
+        states[i] = game.data;
+        scores[i] = i;
+    }
+    init_view(NULL, settings);
+    menu_ctx = (menu_ctx_t){settings, NULL, 0, frame, NULL, &font_wArial_88, &font_wArial_44, {0}};
+    for (int i = 1; i < ITEMS_ON_PAGE; i++) {
+        menu_ctx.y_offsets[i] = menu_ctx.y_offsets[i - 1] + 4 * PADDING + MENU_FONT_SIZE + SPACING;
+    }
+
+    fprintf(results, "name,iterations,mean_ns,p50_ns,p90_ns,p99_ns,min_ns,max_ns,cmd_writes_per_op,data_writes_per_op,data2x_writes_per_op\n");
+    bench_result_t result;
+    run_bench(&result, "update", bench_update, iterations, samples);
+    print_result(&result);
+    run_bench(&result, "update_view", bench_update_view, iterations, samples);
+    print_result(&result);
+    run_bench(&result, "put_string", bench_put_string, iterations, samples);
+    print_result(&result);
+    run_bench(&result, "fill_menu", bench_fill_menu, iterations / 100 > 0 ? iterations / 100 : 1, samples);
+    print_result(&result);
+    run_bench(&result, "menu_step", bench_menu_step, iterations / 100 > 0 ? iterations / 100 : 1, samples);
+    print_result(&result);
+    run_bench(&result, "menu_step_full", bench_menu_step_full, iterations / 100 > 0 ? iterations / 100 : 1, samples);
+    print_result(&result);
+    run_bench(&result, "menu_color_step", bench_color_step, iterations / 100 > 0 ? iterations / 100 : 1, samples);
+    print_result(&result);
+    run_bench(&result, "better_ai_move", bench_better_ai_move, iterations, samples);
+    print_result(&result);
+    run_bench(&result, "expert_ai_move", bench_expert_ai_move, iterations, samples);
+    print_result(&result);
+    run_bench(&result, "policy_ai_move", bench_policy_ai_move, iterations, samples);
+    print_result(&result);
+    run_bench(&result, "human_ai_move", bench_human_ai_move, iterations, samples);
+    print_result(&result);
+    for (int c = 0; c < (int)(sizeof(multi_ball_counts) / sizeof(multi_ball_counts[0])); c++) {
+        char update_name[32], view_name[32];
+        multi_settings = *settings;
+        multi_settings.ball_count = multi_ball_counts[c];
+        restart_game(&multi_game, &multi_settings, 1);
+        for (int i = 0; i < MULTI_STATE_COUNT; i++) {
+            if (!update(&multi_game, no_input)) restart_game(&multi_game, &multi_settings, i);
+            multi_data[i] = multi_game.data;
+            if (multi_game.balls.count) {
+                copy_balls(&multi_balls[i], &multi_game.balls);
+            } else {
+                /* a game of one ball has its ball in the game data */
+                multi_balls[i].count = 1;
+                multi_balls[i].pos_x[0] = multi_game.data.ball_pos_x;
+                multi_balls[i].pos_y[0] = multi_game.data.ball_pos_y;
+            }
+        }
+        snprintf(update_name, sizeof(update_name), "update_balls_%d", multi_ball_counts[c]);
+        snprintf(view_name, sizeof(view_name), "update_view_balls_%d", multi_ball_counts[c]);
+        run_bench(&result, update_name, bench_update_multi, iterations, samples);
+        print_result(&result);
+        run_bench(&result, view_name, bench_update_view_multi, iterations / 10 > 0 ? iterations / 10 : 1, samples);
+        print_result(&result);
+    }
+
+    destroy_game_ctx(&game);
+    destroy_game_ctx(&multi_game);
+    unload_policy();
+    destroy_settings(settings);
+    free(membase);
+    fclose(results);
+    return 0;
+}
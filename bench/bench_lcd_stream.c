@@ -0,0 +1,85 @@
+/** @file
+ * Counts the lcd bus transactions needed to send typical frames and areas
+ * with one pixel per write and with the packed two pixel stream of graphics.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "graphics.h"
+#include "mmio_count.h"
+
+static uint16_t frame[LCD_WIDTH * LCD_HEIGHT];
+static uint16_t captured[LCD_WIDTH * LCD_HEIGHT];
+static uint16_t expected[LCD_WIDTH * LCD_HEIGHT];
+
+/**
+ * Send the area the way it was done before the packed stream, one pixel per write.
+ */
+void show_rect_per_pixel(uint16_t* frame, unsigned char* lcd_membase, rect_t rect) {
+    set_lcd_window(lcd_membase, rect);
+    parlcd_write_cmd(lcd_membase, LCD_WRITE);
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        for (int x = rect.x; x < rect.x + rect.width; x++) {
+            parlcd_write_data(lcd_membase, frame[y * LCD_WIDTH + x]);
+        }
+    }
+}
+
+/**
+ * Copy the pixels of the area in the order in which the display consumes them.
+ * @return number of pixels in the area
+ */
+unsigned long expected_pixels(rect_t rect) {
+    unsigned long n = 0;
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        for (int x = rect.x; x < rect.x + rect.width; x++) {
+            expected[n++] = frame[y * LCD_WIDTH + x];
+        }
+    }
+    return n;
+}
+
+/**
+ * Send the area both ways, check the packed stream delivers the same pixels and print the counts.
+ * @return 0 if the pixels match, 1 otherwise
+ */
+int bench_rect(char* name, rect_t rect) {
+    reset_mmio_counts();
+    show_rect_per_pixel(frame, NULL, rect);
+    unsigned long single = mmio_transactions();
+
+    reset_mmio_counts();
+    capture_mmio_pixels(captured, LCD_WIDTH * LCD_HEIGHT);
+    show_frame_rect(frame, NULL, rect);
+    unsigned long packed = mmio_transactions();
+    unsigned long pixels = mmio_counts.pixels;
+
+    unsigned long n = expected_pixels(rect);
+    int ok = pixels == n && !memcmp(captured, expected, n * sizeof(uint16_t));
+    printf("%-16s %4dx%-4d pixels %6lu  per-pixel %6lu  packed %6lu  reduction %5.1f%%  %s\n",
+           name, rect.width, rect.height, n, single, packed, 100.0 * (single - packed) / single, ok ? "ok" : "PIXEL MISMATCH");
+    return !ok;
+}
+
+int main(void) {
+    srand(1);
+    for (int i = 0; i < LCD_WIDTH * LCD_HEIGHT; i++) frame[i] = rand();
+    int failed = 0;
+    failed |= bench_rect("full frame", (rect_t){0, 0, LCD_WIDTH, LCD_HEIGHT});
+    failed |= bench_rect("hud strip", (rect_t){0, 0, LCD_WIDTH, 44});
+    failed |= bench_rect("hud text", (rect_t){190, 0, 101, 44});
+    failed |= bench_rect("paddle", (rect_t){0, 120, 20, 83});
+    failed |= bench_rect("ball", (rect_t){231, 151, 25, 25});
+    failed |= bench_rect("odd window", (rect_t){3, 7, 21, 13});
+    failed |= bench_rect("single column", (rect_t){479, 0, 1, LCD_HEIGHT});
+
+    /* whole frame written through show_frame and cleared by reset_lcd */
+    reset_mmio_counts();
+    show_frame(frame, NULL);
+    printf("%-16s transactions %6lu\n", "show_frame", mmio_transactions());
+    reset_mmio_counts();
+    reset_lcd(NULL);
+    printf("%-16s transactions %6lu\n", "reset_lcd", mmio_transactions());
+    return failed;
+}
@@ -0,0 +1,182 @@
+/** @file
+ * Validation of the trajectory predictor of the AI (predict_face_y() in collision.c) against the game physics. \n
+ * Every state is a random ball between the paddle faces heading to one of them with a velocity the game can produce.
+ * The real physics (sweep_ball(), one call per update) runs until the ball hits the face of a paddle which follows it,
+ * the prediction has to give the same y coordinate to the last unit of fixed_t and the same number of updates. \n
+ * The straight-line prediction the AI used before, folded in whole pixels, is checked on the same states for comparison. \n
+ * Prints one CSV line with the numbers of states, mismatches and pixel misses of the old prediction
+ * and the nanoseconds per prediction and per simulated flight, exits with 1 if any mismatch was found. \n
+ * Usage: bench_predictor [-n states] [-s seed]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "collision.h"
+#include "game.h"
+#include "graphics.h"
+
+#define DEFAULT_STATES 4000000
+#define MAX_REPORTED 10
+#define BATCH_SIZE 1024
+// more updates than any flight across the court takes
+#define MAX_FLIGHT (LCD_WIDTH * 2)
+
+/**
+ * A state of the ball and the results of the simulation and of the predictions.
+ */
+struct state {
+    fixed_t x, y, vel_x, vel_y;
+    fixed_t simulated_y, predicted_y;
+    int simulated_ticks, predicted_ticks;
+};
+
+static unsigned long long rng_state;
+
+static unsigned int next_random(void) {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (unsigned int)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+static int random_range(int low, int high) {
+    return low + (int)(next_random() % (unsigned int)(high - low + 1));
+}
+
+static long long now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+static double to_pixels(fixed_t f) {
+    return (double)f / FIXED_ONE;
+}
+
+/**
+ * Generate a random state of the ball between the paddle faces.
+ */
+static void random_state(struct state* st) {
+    static const int speeds[] = {BALL_SPEED_EASY, BALL_SPEED_MEDIUM, BALL_SPEED_HARD};
+    int speed = speeds[next_random() % 3];
+    st->x = random_range(INT_TO_FIXED(PADDLE_WIDTH), INT_TO_FIXED(LCD_WIDTH - PADDLE_WIDTH - BALL_SIZE));
+    st->y = random_range(INT_TO_FIXED(LIVES_FONT_SIZE), INT_TO_FIXED(LCD_HEIGHT - BALL_SIZE));
+    // every eighth ball starts exactly on a wall or on a whole pixel, where the rounding is the most fragile
+    switch (next_random() % 8) {
+        case 0:
+            st->y = next_random() % 2 ? INT_TO_FIXED(LIVES_FONT_SIZE) : INT_TO_FIXED(LCD_HEIGHT - BALL_SIZE);
+            break;
+        case 1:
+            st->x = INT_TO_FIXED(FIXED_TO_INT(st->x));
+            st->y = INT_TO_FIXED(FIXED_TO_INT(st->y));
+            break;
+    }
+    // the game moves the ball by the whole speed on the x axis, every fourth ball has any other x velocity
+    st->vel_x = next_random() % 4 ? INT_TO_FIXED(speed) : random_range(FIXED_ONE, INT_TO_FIXED(2 * BALL_SPEED_HARD));
+    if (next_random() % 2) st->vel_x = -st->vel_x;
+    // the steepest bounce off a paddle is BOUNCE_CONST * speed
+    st->vel_y = next_random() % 16 == 0 ? 0 : random_range(-INT_TO_FIXED(BOUNCE_CONST * speed), INT_TO_FIXED(BOUNCE_CONST * speed));
+}
+
+/**
+ * Run the real physics until the ball hits the paddle face it is heading to. The paddle follows the ball,
+ * so the ball cannot miss it.
+ */
+static void simulate(struct state* st) {
+    fixed_t x = st->x, y = st->y, vel_x = st->vel_x, vel_y = st->vel_y;
+    int side = vel_x > 0;
+    struct contact contacts[MAX_CONTACTS];
+    st->simulated_ticks = -1;
+    for (int tick = 1; tick <= MAX_FLIGHT; tick++) {
+        int paddle_y[2];
+        paddle_y[side] = FIXED_TO_INT(y) - (PADDLE_HEIGHT - BALL_SIZE) / 2;
+        paddle_y[!side] = LIVES_FONT_SIZE;
+        int count = sweep_ball(&x, &y, &vel_x, &vel_y, paddle_y, BALL_SPEED_HARD, contacts);
+        for (int i = 0; i < count; i++) {
+            if (contacts[i].surface == SURFACE_PADDLE_FACE) {
+                st->simulated_y = contacts[i].y;
+                st->simulated_ticks = tick;
+                return;
+            }
+        }
+        if (count && contacts[count - 1].surface == SURFACE_GOAL) return;
+    }
+}
+
+/**
+ * The prediction of the AI before predict_face_y(): a straight line to the paddle face folded in whole pixels.
+ */
+static int straight_line_y(struct state* st) {
+    fixed_t limit = st->vel_x > 0 ? INT_TO_FIXED(LCD_WIDTH - PADDLE_WIDTH - BALL_SIZE) : INT_TO_FIXED(PADDLE_WIDTH);
+    int y = FIXED_ROUND(st->y + FIXED_MUL_DIV(limit - st->x, st->vel_y, st->vel_x));
+    while (y < LIVES_FONT_SIZE || y > LCD_HEIGHT - BALL_SIZE) {
+        y = y < LIVES_FONT_SIZE ? 2 * LIVES_FONT_SIZE - y : 2 * (LCD_HEIGHT - BALL_SIZE) - y;
+    }
+    return y;
+}
+
+int main(int argc, char* argv[]) {
+    long states = DEFAULT_STATES;
+    unsigned long long seed = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+            case 'n':
+                states = atol(optarg);
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n states] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (states < 1) {
+        fprintf(stderr, "the number of states must be positive\n");
+        return 1;
+    }
+    rng_state = seed * 0x9e3779b97f4a7c15ULL + 1;
+
+    // the states are predicted and simulated in batches, so the clock is read only a few times per batch
+    static struct state batch[BATCH_SIZE];
+    long mismatches = 0, old_misses = 0;
+    long long predict_ns = 0, simulate_ns = 0, flight_ticks = 0;
+    for (long done = 0; done < states; done += BATCH_SIZE) {
+        int size = states - done < BATCH_SIZE ? states - done : BATCH_SIZE;
+        for (int i = 0; i < size; i++) random_state(&batch[i]);
+        long long start = now_ns();
+        for (int i = 0; i < size; i++) {
+            struct state* st = &batch[i];
+            st->predicted_y = predict_face_y(st->x, st->y, st->vel_x, st->vel_y, &st->predicted_ticks);
+        }
+        long long middle = now_ns();
+        for (int i = 0; i < size; i++) simulate(&batch[i]);
+        long long end = now_ns();
+        predict_ns += middle - start;
+        simulate_ns += end - middle;
+        for (int i = 0; i < size; i++) {
+            struct state* st = &batch[i];
+            flight_ticks += st->simulated_ticks;
+            if (FIXED_ROUND(st->simulated_y) != straight_line_y(st)) old_misses++;
+            if (st->simulated_y == st->predicted_y && st->simulated_ticks == st->predicted_ticks) continue;
+            if (mismatches < MAX_REPORTED) {
+                fprintf(stderr, "mismatch: start %.6f %.6f velocity %.6f %.6f simulated %.6f after %d predicted %.6f after %d\n",
+                        to_pixels(st->x), to_pixels(st->y), to_pixels(st->vel_x), to_pixels(st->vel_y),
+                        to_pixels(st->simulated_y), st->simulated_ticks, to_pixels(st->predicted_y), st->predicted_ticks);
+            }
+            mismatches++;
+        }
+    }
+
+    printf("states,mismatches,old_pixel_misses,mean_flight_ticks,ns_per_prediction,ns_per_simulation\n");
+    printf("%ld,%ld,%ld,%.1f,%.1f,%.1f\n", states, mismatches, old_misses, (double)flight_ticks / states,
+           (double)predict_ns / states, (double)simulate_ns / states);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,62 @@
+/** @file
+ * Replacement of the parallel lcd low level access for benchmarks on a host computer.
+ */
+
+#include "mmio_count.h"
+#include "mzapo_parlcd.h"
+#include "graphics.h"
+
+mmio_counts_t mmio_counts;
+
+static char writing_pixels;
+static uint16_t* capture;
+static unsigned long capture_size;
+
+void reset_mmio_counts(void) {
+    mmio_counts = (mmio_counts_t){0, 0, 0, 0};
+    writing_pixels = 0;
+    capture = NULL;
+    capture_size = 0;
+}
+
+void capture_mmio_pixels(uint16_t* buffer, unsigned long size) {
+    capture = buffer;
+    capture_size = size;
+}
+
+unsigned long mmio_transactions(void) {
+    return mmio_counts.cmd_writes + mmio_counts.data_writes + mmio_counts.data2x_writes;
+}
+
+/**
+ * Store one pixel sent to the display if capturing is on.
+ */
+static void put_pixel_out(uint16_t pixel) {
+    if (capture && mmio_counts.pixels < capture_size) capture[mmio_counts.pixels] = pixel;
+    mmio_counts.pixels++;
+}
+
+void parlcd_write_cmd(unsigned char *parlcd_mem_base, uint16_t cmd) {
+    mmio_counts.cmd_writes++;
+    writing_pixels = cmd == LCD_WRITE;
+    if (writing_pixels) mmio_counts.pixels = 0;
+}
+
+void parlcd_write_data(unsigned char *parlcd_mem_base, uint16_t data) {
+    mmio_counts.data_writes++;
+    if (writing_pixels) put_pixel_out(data);
+}
+
+void parlcd_write_data2x(unsigned char *parlcd_mem_base, uint32_t data) {
+    mmio_counts.data2x_writes++;
+    if (writing_pixels) {
+        put_pixel_out(data & 0xffffu);
+        put_pixel_out(data >> 16);
+    }
+}
+
+void parlcd_delay(int msec) {
+}
+
+void parlcd_hx8357_init(unsigned char *parlcd_mem_base) {
+}
@@ -0,0 +1,45 @@
+/** @file
+ * Replacement of the parallel lcd low level access for benchmarks on a host computer. \n
+ * Instead of writing to the lcd registers it counts the bus transactions
+ * and optionally captures the pixels that would be sent to the display.
+ */
+
+#ifndef MMIO_COUNT_H
+#define MMIO_COUNT_H
+
+#include <stdint.h>
+
+/**
+ * Numbers of writes to the lcd registers since the last reset_mmio_counts().
+ */
+typedef struct mmio_counts {
+    /** writes to the command register */
+    unsigned long cmd_writes;
+    /** 16bit writes to the data register */
+    unsigned long data_writes;
+    /** 32bit writes to the data register */
+    unsigned long data2x_writes;
+    /** pixels sent to the data register after the last LCD_WRITE command */
+    unsigned long pixels;
+} mmio_counts_t;
+
+extern mmio_counts_t mmio_counts;
+
+/**
+ * Set all counters to zero and stop capturing pixels.
+ */
+void reset_mmio_counts(void);
+
+/**
+ * Capture the pixels written after the next LCD_WRITE command into the given buffer.
+ * @param buffer the buffer for the captured pixels
+ * @param size the capacity of the buffer in pixels
+ */
+void capture_mmio_pixels(uint16_t* buffer, unsigned long size);
+
+/**
+ * Return the total number of bus transactions on the lcd registers.
+ */
+unsigned long mmio_transactions(void);
+
+#endif
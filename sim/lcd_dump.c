@@ -0,0 +1,77 @@
+/** @file
+ * Reads the framebuffer of the simulated lcd display from shared memory and writes it as a PPM image. \n
+ * Usage: lcd_dump [output.ppm] [count interval_ms] \n
+ * With count and interval it writes a numbered image every interval (output_0000.ppm, ...).
+ */
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "sim_lcd.h"
+
+/**
+ * Write the framebuffer as binary PPM converting the pixels from rgb 565 to 24 bit rgb.
+ * @return 0 on success, 1 on error
+ */
+int write_ppm(sim_lcd_t* lcd, FILE* out) {
+    fprintf(out, "P6\n%u %u\n255\n", lcd->width, lcd->height);
+    for (uint32_t i = 0; i < lcd->width * lcd->height; i++) {
+        uint16_t pixel = lcd->pixels[i];
+        unsigned char rgb[3] = {
+            (unsigned char)(((pixel >> 11) & 0x1f) * 255 / 31),
+            (unsigned char)(((pixel >> 5) & 0x3f) * 255 / 63),
+            (unsigned char)((pixel & 0x1f) * 255 / 31)
+        };
+        if (fwrite(rgb, 1, 3, out) != 3) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int fd = shm_open(SIM_LCD_SHM_NAME, O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "simulated lcd %s not found, is the game running?\n", SIM_LCD_SHM_NAME);
+        return 1;
+    }
+    sim_lcd_t* lcd = mmap(NULL, sizeof(sim_lcd_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (lcd == MAP_FAILED || lcd->magic != SIM_LCD_MAGIC) {
+        fprintf(stderr, "simulated lcd is not initialized\n");
+        return 1;
+    }
+    int count = argc > 3 ? atoi(argv[2]) : 1;
+    int interval = argc > 3 ? atoi(argv[3]) : 0;
+    for (int i = 0; i < count; i++) {
+        FILE* out = stdout;
+        if (argc > 1) {
+            char name[512];
+            if (count > 1) {
+                char* dot = strrchr(argv[1], '.');
+                int base = dot ? (int)(dot - argv[1]) : (int)strlen(argv[1]);
+                snprintf(name, sizeof(name), "%.*s_%04d.ppm", base, argv[1], i);
+            } else {
+                snprintf(name, sizeof(name), "%s", argv[1]);
+            }
+            out = fopen(name, "wb");
+            if (!out) {
+                fprintf(stderr, "cannot open %s\n", name);
+                return 1;
+            }
+        }
+        int error = write_ppm(lcd, out);
+        if (out != stdout) fclose(out);
+        if (error) return 1;
+        if (i + 1 < count) {
+            struct timespec delay = {.tv_sec = interval / 1000, .tv_nsec = (interval % 1000) * 1000000L};
+            nanosleep(&delay, NULL);
+        }
+    }
+    fprintf(stderr, "lcd writes: %u, cmd %llu, data %llu, data2x %llu\n", lcd->write_count,
+            (unsigned long long)lcd->cmd_writes, (unsigned long long)lcd->data_writes, (unsigned long long)lcd->data2x_writes);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/** @file
+ * Simulator of the MZ_APO peripherals for running the game on a host computer. \n
+ * Replaces mzapo_phys.c and mzapo_parlcd.c: the peripheral registers are backed by anonymous
+ * memory and the lcd command and data stream is decoded into a framebuffer in shared memory
+ * (see sim_lcd.h), which can be read by lcd_dump.
+ */
+
+#define _GNU_SOURCE
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "mzapo_phys.h"
+#include "mzapo_parlcd.h"
+#include "sim_lcd.h"
+
+#define CMD_COLUMN_ADDRESS_SET 0x2a
+#define CMD_PAGE_ADDRESS_SET 0x2b
+#define CMD_MEMORY_WRITE 0x2c
+
+void write_pixel(uint16_t pixel);
+
+static sim_lcd_t* lcd = NULL;
+static uint16_t command;
+static int argument_count;
+static uint16_t arguments[4];
+static int column_start = 0, column_end = SIM_LCD_WIDTH - 1;
+static int page_start = 0, page_end = SIM_LCD_HEIGHT - 1;
+static int cursor_x, cursor_y;
+
+/**
+ * Get the framebuffer of the simulated display, it is created on the first call.
+ * @return pointer to the framebuffer
+ */
+sim_lcd_t* get_sim_lcd(void) {
+    if (lcd) return lcd;
+    char* use_shm = getenv(SIM_LCD_SHM_ENV);
+    if (!use_shm || strcmp(use_shm, "0")) {
+        int fd = shm_open(SIM_LCD_SHM_NAME, O_RDWR | O_CREAT, 0644);
+        if (fd >= 0 && ftruncate(fd, sizeof(sim_lcd_t)) == 0) {
+            void* mem = mmap(NULL, sizeof(sim_lcd_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mem != MAP_FAILED) lcd = (sim_lcd_t*)mem;
+        }
+        if (fd >= 0) close(fd);
+        if (!lcd) fprintf(stderr, "cannot create shared memory %s, lcd stays private\n", SIM_LCD_SHM_NAME);
+    }
+    if (!lcd) {
+        void* mem = mmap(NULL, sizeof(sim_lcd_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            fprintf(stderr, "cannot allocate simulated lcd\n");
+            exit(1);
+        }
+        lcd = (sim_lcd_t*)mem;
+    }
+    memset(lcd, 0, sizeof(sim_lcd_t));
+    lcd->width = SIM_LCD_WIDTH;
+    lcd->height = SIM_LCD_HEIGHT;
+    lcd->magic = SIM_LCD_MAGIC;
+    return lcd;
+}
+
+/**
+ * Set all traffic statistics of the simulated display to zero.
+ */
+void reset_sim_lcd_counts(void) {
+    sim_lcd_t* sim = get_sim_lcd();
+    sim->cmd_writes = 0;
+    sim->data_writes = 0;
+    sim->data2x_writes = 0;
+    sim->pixels_written = 0;
+}
+
+/**
+ * Every peripheral region is backed by zeroed anonymous memory, so the registers
+ * of the knobs and leds keep the last written value and the knobs never move.
+ */
+void *map_phys_address(off_t region_base, size_t region_size, int opt_cached) {
+    void* mem = mmap(NULL, region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        fprintf(stderr, "mmap error\n");
+        return NULL;
+    }
+    get_sim_lcd();
+    return mem;
+}
+
+void parlcd_write_cmd(unsigned char *parlcd_mem_base, uint16_t cmd) {
+    get_sim_lcd()->cmd_writes++;
+    command = cmd;
+    argument_count = 0;
+    if (cmd == CMD_MEMORY_WRITE) {
+        cursor_x = column_start;
+        cursor_y = page_start;
+        lcd->write_count++;
+    }
+}
+
+void parlcd_write_data(unsigned char *parlcd_mem_base, uint16_t data) {
+    get_sim_lcd()->data_writes++;
+    if (command == CMD_MEMORY_WRITE) {
+        write_pixel(data);
+    } else if ((command == CMD_COLUMN_ADDRESS_SET || command == CMD_PAGE_ADDRESS_SET) && argument_count < 4) {
+        arguments[argument_count++] = data & 0xffu;
+        if (argument_count == 4) {
+            int start = arguments[0] << 8 | arguments[1];
+            int end = arguments[2] << 8 | arguments[3];
+            if (command == CMD_COLUMN_ADDRESS_SET) {
+                column_start = start;
+                column_end = end;
+            } else {
+                page_start = start;
+                page_end = end;
+            }
+        }
+    }
+}
+
+/**
+ * The first pixel of the pair is in the lower half, the same way graphics.c packs them.
+ */
+void parlcd_write_data2x(unsigned char *parlcd_mem_base, uint32_t data) {
+    get_sim_lcd()->data2x_writes++;
+    if (command == CMD_MEMORY_WRITE) {
+        write_pixel(data & 0xffffu);
+        write_pixel(data >> 16);
+    }
+}
+
+void parlcd_delay(int msec) {
+    struct timespec wait_delay = {.tv_sec = msec / 1000,
+                                  .tv_nsec = (msec % 1000) * 1000 * 1000};
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &wait_delay, NULL);
+}
+
+void parlcd_hx8357_init(unsigned char *parlcd_mem_base) {
+    get_sim_lcd();
+    column_start = 0;
+    column_end = SIM_LCD_WIDTH - 1;
+    page_start = 0;
+    page_end = SIM_LCD_HEIGHT - 1;
+}
+
+/**
+ * Store the pixel at the cursor and move the cursor within the window like the lcd controller does.
+ */
+void write_pixel(uint16_t pixel) {
+    if (cursor_y > page_end) return;
+    if (cursor_x < SIM_LCD_WIDTH && cursor_y < SIM_LCD_HEIGHT) {
+        lcd->pixels[cursor_y * SIM_LCD_WIDTH + cursor_x] = pixel;
+    }
+    lcd->pixels_written++;
+    if (++cursor_x > column_end) {
+        cursor_x = column_start;
+        cursor_y++;
+    }
+}
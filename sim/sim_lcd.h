@@ -0,0 +1,52 @@
+/** @file
+ * Layout of the simulated lcd display shared between the simulator backend and the viewers. \n
+ * The simulator decodes the command and data stream sent to the parallel lcd into this framebuffer.
+ */
+
+#ifndef SIM_LCD_H
+#define SIM_LCD_H
+
+#include <stdint.h>
+
+#define SIM_LCD_SHM_NAME "/apong_lcd"
+#define SIM_LCD_MAGIC (0x41504f4eu)
+#define SIM_LCD_WIDTH 480
+#define SIM_LCD_HEIGHT 320
+
+/* set this environment variable to 0 to keep the framebuffer private to the game process */
+#define SIM_LCD_SHM_ENV "APONG_SIM_SHM"
+
+/**
+ * Framebuffer of the simulated display and statistics of the traffic on its registers.
+ */
+typedef struct sim_lcd {
+    /** SIM_LCD_MAGIC once the framebuffer is initialized */
+    uint32_t magic;
+    /** dimensions of the display in pixels */
+    uint32_t width, height;
+    /** incremented after every LCD_WRITE command, viewers can detect new frames by it */
+    volatile uint32_t write_count;
+    /** writes to the command register */
+    uint64_t cmd_writes;
+    /** 16bit writes to the data register */
+    uint64_t data_writes;
+    /** 32bit writes to the data register */
+    uint64_t data2x_writes;
+    /** pixels written to the display */
+    uint64_t pixels_written;
+    /** pixels of the display in rgb 565 format, row by row */
+    uint16_t pixels[SIM_LCD_WIDTH * SIM_LCD_HEIGHT];
+} sim_lcd_t;
+
+/**
+ * Get the framebuffer of the simulated display, it is created on the first call.
+ * @return pointer to the framebuffer
+ */
+sim_lcd_t* get_sim_lcd(void);
+
+/**
+ * Set all traffic statistics of the simulated display to zero.
+ */
+void reset_sim_lcd_counts(void);
+
+#endif
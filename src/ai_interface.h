@@ -1,20 +1,55 @@
 /** @file
- * This is an interface describing the functions which AI implementations should implement. \n
- * This file is not to be included anywhere nor to be implemented directly (as ai_interface.c).
+ * This is the interface every AI implements. \n
+ * An AI is a constant structure of functions, each paddle controlled by it has its own instance state
+ * (struct ai_state of game.h), so any number of games and paddles can use the same AI at once. \n
+ * New AIs are added to the registry in ai_registry.c.
  */
 
-#include "game.h" // struct game_data
+#ifndef AI_INTERFACE_H
+#define AI_INTERFACE_H
+
+#include "game.h" // struct game_data, struct ai_state
 #include "graphics.h" // LCD_HEIGHT, LCD_WIDTH
 
 /**
- * This funciton is called every game update to determine the AI's movement. \n
- * Implementations of AI are to rename this function to "name_of_the_ai_move".
- * @param is_right 0 if the AI controls the left paddle, \n
- *                 1 if the AI controls the right paddle
- * @param game_data a structure containing all information about the state of the game
- * @return -1 for moving up \n
- *          0 for not moving \n
- *          1 for moving down \n
- * @see game.h for struct game_data
+ * Functions of one AI implementation.
  */
-char ai_move(char is_right, struct game_data game_data);
+typedef struct ai_interface {
+    /** the name of the AI shown in the menu and in the reports */
+    char* label;
+    /** the number of bytes of struct ai_state the AI uses, from the start of the words */
+    int state_size;
+    /**
+     * Prepare the state of a paddle for a new game, NULL if the zeroed state is enough.
+     * @param state the zeroed state of the paddle, the AI keeps its own structure in it
+     * @param is_right 0 if the AI controls the left paddle, 1 if the AI controls the right paddle
+     */
+    void (*init)(struct ai_state* state, char is_right);
+    /**
+     * This funciton is called every game update to determine the AI's movement.
+     * @param is_right 0 if the AI controls the left paddle, \n
+     *                 1 if the AI controls the right paddle
+     * @param game_data a structure containing all information about the state of the game
+     * @param state the state the AI keeps between updates for this paddle
+     * @param seed the state of the random numbers of the game, to be used with rand_r
+     * @return -1 for moving up \n
+     *          0 for not moving \n
+     *          1 for moving down \n
+     * @see game.h for struct game_data and struct ai_state
+     */
+    char (*move)(char is_right, struct game_data game_data, struct ai_state* state, unsigned int* seed);
+    /**
+     * Release everything init acquired, NULL if there is nothing to release.
+     * @param state the state of the paddle
+     */
+    void (*destroy)(struct ai_state* state);
+    /**
+     * Prepare the state of a paddle for a new ball to follow in the multi-ball mode,
+     * NULL to start from a new state by destroy and init.
+     * @param state the state of the paddle
+     * @param is_right 0 if the AI controls the left paddle, 1 if the AI controls the right paddle
+     */
+    void (*refocus)(struct ai_state* state, char is_right);
+} ai_interface_t;
+
+#endif
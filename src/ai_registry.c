@@ -0,0 +1,30 @@
+/** @file
+*/
+
+#include "ai_registry.h"
+#include "basic_ai.h"
+#include "better_ai.h"
+#include "expert_ai.h"
+#include "policy_ai.h"
+#include "human_ai.h"
+
+// the order gives the ids of the AIs, DUMB_AI, SMARTER_AI, EXPERT_AI, POLICY_AI and HUMAN_AI of settings.h
+static const ai_interface_t* ais[] = {&basic_ai, &better_ai, &expert_ai, &policy_ai, &human_ai};
+
+/**
+ * Gets the number of registered AIs.
+ * @return the number of AIs, the ids are 0 to the number - 1
+ */
+int get_ai_count(void) {
+    return sizeof(ais) / sizeof(ais[0]);
+}
+
+/**
+ * Gets the AI with the given id.
+ * @param id the index of the AI in the registry
+ * @return the AI, NULL if there is no AI with this id
+ */
+const ai_interface_t* get_ai(int id) {
+    if (id < 0 || id >= get_ai_count()) return NULL;
+    return ais[id];
+}
@@ -0,0 +1,24 @@
+/** @file
+ * Registry of all AI implementations, an AI is identified by its index in the registry. \n
+ * The settings, the menu, the headless mode and the tournament list the AIs from here.
+ */
+
+#ifndef AI_REGISTRY_H
+#define AI_REGISTRY_H
+
+#include "ai_interface.h"
+
+/**
+ * Gets the number of registered AIs.
+ * @return the number of AIs, the ids are 0 to the number - 1
+ */
+int get_ai_count(void);
+
+/**
+ * Gets the AI with the given id.
+ * @param id the index of the AI in the registry
+ * @return the AI, NULL if there is no AI with this id
+ */
+const ai_interface_t* get_ai(int id);
+
+#endif
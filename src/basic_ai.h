@@ -5,20 +5,24 @@
 #ifndef BASIC_AI_H
 #define BASIC_AI_H
 
-#include "game.h"
-#include "graphics.h"
+#include "ai_interface.h"
 
 /**
  * This funciton is called every game update to determine the AI's movement. \n
- * Implementations of AI are to rename this function to "name_of_the_ai_move".
+ * It is the move function of the AI, see ai_interface.h.
  * @param is_right 0 if the AI controls the left paddle, \n
  *                 1 if the AI controls the right paddle
  * @param game_data a structure containing all information about the state of the game
+ * @param state the state the AI keeps between updates for this paddle
+ * @param seed the state of the random numbers of the game, to be used with rand_r
  * @return -1 for moving up \n
  *          0 for not moving \n
  *          1 for moving down
- * @see game.h for struct game_data
+ * @see game.h for struct game_data and struct ai_state
  */
-char basic_ai_move(char is_right, struct game_data game_data);
+char basic_ai_move(char is_right, struct game_data game_data, struct ai_state* state, unsigned int* seed);
+
+/** the AI following the ball, it keeps no state */
+extern const ai_interface_t basic_ai;
 
 #endif
@@ -0,0 +1,233 @@
+/** @file
+*/
+
+#include "collision.h"
+#include "game.h"
+#include "graphics.h"
+
+// the contacts are ordered by the part of the step before them with 32 fractional bits,
+// which is much finer than a unit of fixed_t even at speeds of thousands of pixels per update
+#define STEP_SHIFT (32)
+#define STEP_END ((int64_t)1 << STEP_SHIFT)
+
+char cross_line(fixed_t from, fixed_t delta, fixed_t limit, char dir, fixed_t other_from, fixed_t other_delta, fixed_t* other_at, int64_t* t);
+char cross_boundary(fixed_t from, fixed_t delta, fixed_t limit, char dir, fixed_t other_from, fixed_t other_delta, fixed_t* other_at, int64_t* t);
+void keep_earliest(struct contact* best, int64_t* best_t, char surface, char side, int64_t t, fixed_t x, fixed_t y);
+fixed_t paddle_hit_vel_y(int paddle_y, fixed_t ball_y, int ball_speed);
+void skip_wall_bounces(fixed_t* pos_y, fixed_t* vel_y, int updates);
+
+/**
+ * Move the ball by its velocity for one update and resolve all contacts on its way in the order they happen. \n
+ * A hit of the paddle face changes the y velocity of the ball according to the place of the hit,
+ * the edges of the paddles and the walls reflect it. The ball stops at a goal.
+ * @param pos_x the x coordinate of the ball, updated
+ * @param pos_y the y coordinate of the ball, updated
+ * @param vel_x the x velocity of the ball, updated
+ * @param vel_y the y velocity of the ball, updated
+ * @param paddle_y the y coordinates of the left and of the right paddle in pixels
+ * @param ball_speed the speed of the ball in pixels per update, sets the y velocity after a paddle hit
+ * @param contacts array of MAX_CONTACTS contacts filled in the order they happened
+ * @return the number of contacts, the last one is SURFACE_GOAL if the ball was lost
+ */
+int sweep_ball(fixed_t* pos_x, fixed_t* pos_y, fixed_t* vel_x, fixed_t* vel_y, int paddle_y[2], int ball_speed, struct contact* contacts) {
+    const fixed_t top = INT_TO_FIXED(LIVES_FONT_SIZE);
+    const fixed_t bottom = INT_TO_FIXED(LCD_HEIGHT - BALL_SIZE);
+    const fixed_t faces[2] = {INT_TO_FIXED(PADDLE_WIDTH), INT_TO_FIXED(LCD_WIDTH - PADDLE_WIDTH - BALL_SIZE)};
+    const fixed_t goals[2] = {0, INT_TO_FIXED(LCD_WIDTH - BALL_SIZE)};
+    int count = 0;
+    // the part of the path of this update the ball has not travelled yet
+    fixed_t dx = *vel_x, dy = *vel_y;
+    while ((dx || dy) && count < MAX_CONTACTS) {
+        fixed_t x = *pos_x, y = *pos_y;
+        struct contact best;
+        int64_t best_t = STEP_END + 1;
+        fixed_t at;
+        int64_t t;
+        if (cross_boundary(y, dy, top, -1, x, dx, &at, &t)) keep_earliest(&best, &best_t, SURFACE_WALL_TOP, 0, t, at, top);
+        if (cross_boundary(y, dy, bottom, 1, x, dx, &at, &t)) keep_earliest(&best, &best_t, SURFACE_WALL_BOTTOM, 0, t, at, bottom);
+        for (int side = 0; side < 2; side++) {
+            // the ball overlaps the paddle between these y coordinates
+            fixed_t paddle_top = INT_TO_FIXED(paddle_y[side] - BALL_SIZE);
+            fixed_t paddle_bottom = INT_TO_FIXED(paddle_y[side] + PADDLE_HEIGHT);
+            char outwards = side ? 1 : -1;
+            // the corners belong to the face, so a ball cannot slip between the face and an edge
+            if (cross_line(x, dx, faces[side], outwards, y, dy, &at, &t) && at >= paddle_top && at <= paddle_bottom) {
+                keep_earliest(&best, &best_t, SURFACE_PADDLE_FACE, side, t, faces[side], at);
+            }
+            // the edges are hit by a ball which is already behind the face
+            if (cross_line(y, dy, paddle_top, 1, x, dx, &at, &t) && (side ? at > faces[side] : at < faces[side])) {
+                keep_earliest(&best, &best_t, SURFACE_PADDLE_TOP, side, t, at, paddle_top);
+            }
+            if (cross_line(y, dy, paddle_bottom, -1, x, dx, &at, &t) && (side ? at > faces[side] : at < faces[side])) {
+                keep_earliest(&best, &best_t, SURFACE_PADDLE_BOTTOM, side, t, at, paddle_bottom);
+            }
+            if (cross_boundary(x, dx, goals[side], outwards, y, dy, &at, &t)) keep_earliest(&best, &best_t, SURFACE_GOAL, side, t, goals[side], at);
+        }
+        if (best_t > STEP_END) {
+            *pos_x = x + dx;
+            *pos_y = y + dy;
+            return count;
+        }
+        *pos_x = best.x;
+        *pos_y = best.y;
+        contacts[count++] = best;
+        // the rest of the path is the part behind the contact, reflected, so a reflection is exact:
+        // the ball ends where the mirror image of the unreflected path ends
+        fixed_t rest_x = x + dx - best.x, rest_y = y + dy - best.y;
+        switch (best.surface) {
+            case SURFACE_WALL_TOP:
+            case SURFACE_WALL_BOTTOM:
+            case SURFACE_PADDLE_TOP:
+            case SURFACE_PADDLE_BOTTOM:
+                *vel_y = -*vel_y;
+                rest_y = -rest_y;
+                break;
+            case SURFACE_PADDLE_FACE:
+                *vel_y = paddle_hit_vel_y(paddle_y[(int)best.side], best.y, ball_speed);
+                // the new y velocity for the same part of the update as the rest of the x path
+                rest_y = FIXED_MUL_DIV(*vel_y, rest_x, *vel_x);
+                *vel_x = -*vel_x;
+                rest_x = -rest_x;
+                break;
+            case SURFACE_GOAL:
+                return count;
+        }
+        dx = rest_x;
+        dy = rest_y;
+    }
+    return count;
+}
+
+/**
+ * Move the ball in O(1) to the start of the update in which it crosses the line of the paddle face it is heading to,
+ * if nothing but the walls is in its way, see predict_face_y().
+ * @param pos_x the x coordinate of the ball, between the paddle faces, updated
+ * @param pos_y the y coordinate of the ball, updated
+ * @param vel_x the x velocity of the ball
+ * @param vel_y the y velocity of the ball, updated
+ * @return the number of skipped updates, -1 if the ball does not move on the x axis or is behind the line
+ */
+int skip_to_face_update(fixed_t* pos_x, fixed_t* pos_y, fixed_t vel_x, fixed_t* vel_y) {
+    fixed_t face = vel_x < 0 ? INT_TO_FIXED(PADDLE_WIDTH) : INT_TO_FIXED(LCD_WIDTH - PADDLE_WIDTH - BALL_SIZE);
+    fixed_t distance = vel_x < 0 ? *pos_x - face : face - *pos_x;
+    if (vel_x == 0 || distance < 0) return -1;
+    // the updates which end in front of the line, the ball crosses it in the next one
+    int updates = distance / (vel_x < 0 ? -vel_x : vel_x);
+    *pos_x += updates * vel_x;
+    skip_wall_bounces(pos_y, vel_y, updates);
+    return updates;
+}
+
+/**
+ * Predict where the ball crosses the line of the paddle face it is heading to, if nothing but the walls is in its way. \n
+ * The result is exactly the y coordinate sweep_ball() reports for a hit of that face. The updates before the crossing
+ * are skipped in O(1) by unfolding the wall reflections, only the update of the crossing is swept.
+ * @param pos_x the x coordinate of the ball, between the paddle faces
+ * @param pos_y the y coordinate of the ball
+ * @param vel_x the x velocity of the ball
+ * @param vel_y the y velocity of the ball
+ * @param ticks the number of updates until the crossing is stored here, can be NULL
+ * @return the y coordinate of the ball at the crossing, pos_y if the ball does not move on the x axis
+ */
+fixed_t predict_face_y(fixed_t pos_x, fixed_t pos_y, fixed_t vel_x, fixed_t vel_y, int* ticks) {
+    int updates = skip_to_face_update(&pos_x, &pos_y, vel_x, &vel_y);
+    if (ticks) *ticks = updates + 1;
+    if (updates < 0) return pos_y;
+    // the y of a face hit does not depend on the paddle, so a paddle is put where it surely is hit:
+    // it reaches (PADDLE_HEIGHT + BALL_SIZE) / 2 from the ball, more than the ball moves in one update
+    int paddle_y[2];
+    paddle_y[0] = paddle_y[1] = FIXED_TO_INT(pos_y) - (PADDLE_HEIGHT - BALL_SIZE) / 2;
+    struct contact contacts[MAX_CONTACTS];
+    int count = sweep_ball(&pos_x, &pos_y, &vel_x, &vel_y, paddle_y, 0, contacts);
+    for (int i = 0; i < count; i++) {
+        if (contacts[i].surface == SURFACE_PADDLE_FACE) return contacts[i].y;
+    }
+    return pos_y;
+}
+
+/**
+ * Move the ball on the y axis by the given number of updates in which it touches only the walls, in O(1). \n
+ * The path is unfolded into a straight line from the wall behind the ball and folded back by the length of the court,
+ * a ball bounces off a wall only when it would get behind it. sweep_ball() reflects exactly,
+ * so the result is the same as of the updates run one by one.
+ * @param pos_y the y coordinate of the ball, updated
+ * @param vel_y the y velocity of the ball, updated
+ * @param updates the number of updates
+ */
+void skip_wall_bounces(fixed_t* pos_y, fixed_t* vel_y, int updates) {
+    const fixed_t top = INT_TO_FIXED(LIVES_FONT_SIZE);
+    const fixed_t bottom = INT_TO_FIXED(LCD_HEIGHT - BALL_SIZE);
+    const int64_t span = bottom - top;
+    if (*vel_y == 0 || updates <= 0) return;
+    char down = *vel_y > 0;
+    // the distance travelled from the wall behind the ball along the unfolded path
+    int64_t travel = (down ? *pos_y - top : bottom - *pos_y) + (int64_t)updates * (down ? *vel_y : -*vel_y);
+    // a ball exactly on a wall has not bounced off it yet
+    int64_t bounces = travel > 0 ? (travel - 1) / span : 0;
+    int64_t from_wall = travel - bounces * span;
+    // after an odd number of bounces the ball comes back from the other wall
+    if (bounces % 2) {
+        from_wall = span - from_wall;
+        *vel_y = -*vel_y;
+    }
+    *pos_y = down ? top + (fixed_t)from_wall : bottom - (fixed_t)from_wall;
+}
+
+/**
+ * Find where a step of the ball crosses the line "coordinate == limit" in the given direction.
+ * @param from the coordinate at the start of the step
+ * @param delta the change of the coordinate over the step
+ * @param limit the coordinate of the line
+ * @param dir -1 if the line is crossed towards lower coordinates, 1 towards higher coordinates
+ * @param other_from the other coordinate at the start of the step
+ * @param other_delta the change of the other coordinate over the step
+ * @param other_at the other coordinate at the crossing is stored here
+ * @param t the part of the step before the crossing is stored here, from 0 to STEP_END
+ * @return 1 if the step crosses the line, 0 otherwise
+ */
+char cross_line(fixed_t from, fixed_t delta, fixed_t limit, char dir, fixed_t other_from, fixed_t other_delta, fixed_t* other_at, int64_t* t) {
+    if (dir < 0 ? !(delta < 0 && from >= limit && from + delta < limit) : !(delta > 0 && from <= limit && from + delta > limit)) return 0;
+    *t = ((int64_t)(limit - from) << STEP_SHIFT) / delta;
+    *other_at = other_from + FIXED_MUL_DIV(limit - from, other_delta, delta);
+    return 1;
+}
+
+/**
+ * Same as cross_line() for the walls and the edges of the court, which the ball never crosses. \n
+ * A ball which is a little behind the line because of rounding of an earlier contact touches it right away.
+ */
+char cross_boundary(fixed_t from, fixed_t delta, fixed_t limit, char dir, fixed_t other_from, fixed_t other_delta, fixed_t* other_at, int64_t* t) {
+    if (dir < 0 ? (from < limit && delta < 0) : (from > limit && delta > 0)) {
+        *t = 0;
+        *other_at = other_from;
+        return 1;
+    }
+    return cross_line(from, delta, limit, dir, other_from, other_delta, other_at, t);
+}
+
+/**
+ * Replace the best contact by the given one if it happens sooner, on a tie the first found contact is kept.
+ */
+void keep_earliest(struct contact* best, int64_t* best_t, char surface, char side, int64_t t, fixed_t x, fixed_t y) {
+    if (t >= *best_t) return;
+    *best_t = t;
+    best->surface = surface;
+    best->side = side;
+    best->x = x;
+    best->y = y;
+}
+
+/**
+ * The y velocity of the ball after it hit the face of a paddle, the further from the middle of the paddle the steeper.
+ * @param paddle_y the y coordinate of the paddle in pixels
+ * @param ball_y the y coordinate of the ball at the hit
+ * @param ball_speed the speed of the ball in pixels per update
+ * @return the new y velocity of the ball
+ */
+fixed_t paddle_hit_vel_y(int paddle_y, fixed_t ball_y, int ball_speed) {
+    // distance of the middle of the ball from the middle of the paddle
+    fixed_t relative_hit_y = ball_y - INT_TO_FIXED(paddle_y) + INT_TO_FIXED(BALL_SIZE - PADDLE_HEIGHT) / 2;
+    // BOUNCE_CONST at the very edge of the paddle, i.e. at half of (PADDLE_HEIGHT + BALL_SIZE - 1) from the middle
+    fixed_t ball_dir = FIXED_MUL_DIV(relative_hit_y, 2 * BOUNCE_CONST, PADDLE_HEIGHT + BALL_SIZE - 1);
+    return ball_dir * ball_speed;
+}
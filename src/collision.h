@@ -0,0 +1,81 @@
+/** @file
+ * Swept collision of the ball with the walls, the paddles and the edges of the game court. \n
+ * The ball is moved along its whole path of one update. Whenever the path touches a surface, the earliest contact
+ * is resolved and the ball continues with the rest of the update, so at any speed the ball cannot pass through a paddle
+ * and can bounce several times in one update (e.g. wall, paddle, wall).
+ */
+
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "fixed.h"
+
+// the most contacts resolved in one update, the rest of the path of the ball is dropped after that
+#define MAX_CONTACTS (8)
+
+/**
+ * Surfaces the ball can touch.
+ */
+enum surface {
+    SURFACE_WALL_TOP,
+    SURFACE_WALL_BOTTOM,
+    /** the side of the paddle facing the court */
+    SURFACE_PADDLE_FACE,
+    SURFACE_PADDLE_TOP,
+    SURFACE_PADDLE_BOTTOM,
+    /** the left or the right edge of the court, the ball is lost */
+    SURFACE_GOAL
+};
+
+/**
+ * One contact of the ball with a surface.
+ */
+struct contact {
+    /** one of enum surface */
+    char surface;
+    /** 0 for the left paddle or edge, 1 for the right one, 0 for the walls */
+    char side;
+    /** the position of the ball at the contact */
+    fixed_t x, y;
+};
+
+/**
+ * Move the ball by its velocity for one update and resolve all contacts on its way in the order they happen. \n
+ * A hit of the paddle face changes the y velocity of the ball according to the place of the hit,
+ * the edges of the paddles and the walls reflect it. The ball stops at a goal.
+ * @param pos_x the x coordinate of the ball, updated
+ * @param pos_y the y coordinate of the ball, updated
+ * @param vel_x the x velocity of the ball, updated
+ * @param vel_y the y velocity of the ball, updated
+ * @param paddle_y the y coordinates of the left and of the right paddle in pixels
+ * @param ball_speed the speed of the ball in pixels per update, sets the y velocity after a paddle hit
+ * @param contacts array of MAX_CONTACTS contacts filled in the order they happened
+ * @return the number of contacts, the last one is SURFACE_GOAL if the ball was lost
+ */
+int sweep_ball(fixed_t* pos_x, fixed_t* pos_y, fixed_t* vel_x, fixed_t* vel_y, int paddle_y[2], int ball_speed, struct contact* contacts);
+
+/**
+ * Move the ball in O(1) to the start of the update in which it crosses the line of the paddle face it is heading to,
+ * if nothing but the walls is in its way, see predict_face_y().
+ * @param pos_x the x coordinate of the ball, between the paddle faces, updated
+ * @param pos_y the y coordinate of the ball, updated
+ * @param vel_x the x velocity of the ball
+ * @param vel_y the y velocity of the ball, updated
+ * @return the number of skipped updates, -1 if the ball does not move on the x axis or is behind the line
+ */
+int skip_to_face_update(fixed_t* pos_x, fixed_t* pos_y, fixed_t vel_x, fixed_t* vel_y);
+
+/**
+ * Predict where the ball crosses the line of the paddle face it is heading to, if nothing but the walls is in its way. \n
+ * The result is exactly the y coordinate sweep_ball() reports for a hit of that face. The updates before the crossing
+ * are skipped in O(1) by unfolding the wall reflections, only the update of the crossing is swept.
+ * @param pos_x the x coordinate of the ball, between the paddle faces
+ * @param pos_y the y coordinate of the ball
+ * @param vel_x the x velocity of the ball
+ * @param vel_y the y velocity of the ball
+ * @param ticks the number of updates until the crossing is stored here, can be NULL
+ * @return the y coordinate of the ball at the crossing, pos_y if the ball does not move on the x axis
+ */
+fixed_t predict_face_y(fixed_t pos_x, fixed_t pos_y, fixed_t vel_x, fixed_t vel_y, int* ticks);
+
+#endif
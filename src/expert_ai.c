@@ -0,0 +1,178 @@
+/** @file
+ * When the ball turns towards the paddle, the AI tries every place of the paddle it can reach before the ball arrives.
+ * Each candidate is played with the physics of the game, sweep_ball() for the update of the hit and predict_face_y()
+ * for the way of the returned ball, and the return the opponent has to travel the furthest to is chosen. \n
+ * The plan is kept in the state of the paddle between updates. The search of one update stops after
+ * EXPERT_AI_CANDIDATES candidates and goes on in the next update, the paddle waits meanwhile.
+ */
+
+#include "expert_ai.h"
+#include "collision.h"
+
+/**
+ * State of one paddle, kept in its struct ai_state.
+ */
+struct expert_ai_state {
+    /** the direction of the ball on the x axis at the last update */
+    int32_t ball_x_dir;
+    /** 1 while candidates are left to be tried */
+    int32_t searching;
+    /** the ball at the start of the update in which it reaches the paddle */
+    fixed_t ball_x, ball_y, vel_x, vel_y;
+    /** the updates left until that update including it, the paddle moves once in each of them */
+    int32_t ticks_left;
+    /** the paddle position of the next candidate and of the last one */
+    int32_t next_y, last_y;
+    /** the best candidate so far, best_score is -1 while no candidate returns the ball */
+    int32_t best_y, best_score;
+    int32_t target_paddle_y;
+};
+
+_Static_assert(sizeof(struct expert_ai_state) <= sizeof(struct ai_state), "the state of expert_ai does not fit into struct ai_state");
+
+const ai_interface_t expert_ai = {"EXPERT", sizeof(struct expert_ai_state), NULL, expert_ai_move, NULL, NULL};
+
+void plan_return(struct game_data* game_data, struct expert_ai_state* state);
+void search_returns(char is_right, struct game_data* game_data, struct expert_ai_state* state);
+char can_reach(int from, int to, int ticks);
+int score_return(char is_right, struct game_data* game_data, struct expert_ai_state* state, int paddle_y);
+
+/**
+ * This funciton is called every game update to determine the AI's movement. \n
+ * It is the move function of the AI, see ai_interface.h.
+ * @param is_right 0 if the AI controls the left paddle, \n
+ *                 1 if the AI controls the right paddle
+ * @param game_data a structure containing all information about the state of the game
+ * @param ai_state the state the AI keeps between updates for this paddle
+ * @param seed the state of the random numbers of the game, to be used with rand_r
+ * @return -1 for moving up \n
+ *          0 for not moving \n
+ *          1 for moving down
+ * @see game.h for struct game_data and struct ai_state
+ */
+char expert_ai_move(char is_right, struct game_data game_data, struct ai_state* ai_state, unsigned int* seed) {
+    struct expert_ai_state* state = (struct expert_ai_state*)ai_state->words;
+    // plan again every time the direction of the ball on the x axis changes
+    char ball_x_dir = game_data.ball_vel_x < 0 ? -1 : game_data.ball_vel_x > 0;
+    if (state->ball_x_dir != ball_x_dir) {
+        state->ball_x_dir = ball_x_dir;
+        if (ball_x_dir == (is_right ? 1 : -1)) {
+            plan_return(&game_data, state);
+        } else {
+            state->searching = 0;
+            state->ticks_left = 0;
+            state->target_paddle_y = LIVES_FONT_SIZE + (LCD_HEIGHT - LIVES_FONT_SIZE) / 2 - PADDLE_HEIGHT / 2;
+        }
+    }
+    if (state->searching) search_returns(is_right, &game_data, state);
+    if (state->ticks_left > 0) state->ticks_left--;
+    if (state->searching) return 0;
+    int current_paddle_y = is_right ? game_data.paddle_right_pos : game_data.paddle_left_pos;
+    if (state->target_paddle_y < current_paddle_y) return -1;
+    if (state->target_paddle_y > current_paddle_y) return 1;
+    return 0;
+}
+
+/**
+ * Find the update in which the ball reaches the paddle and start the search of the candidate paddle positions.
+ * @param game_data the state of the game given to the AI
+ * @param state the state of the paddle
+ */
+void plan_return(struct game_data* game_data, struct expert_ai_state* state) {
+    state->ball_x = game_data->ball_pos_x;
+    state->ball_y = game_data->ball_pos_y;
+    state->vel_x = game_data->ball_vel_x;
+    state->vel_y = game_data->ball_vel_y;
+    int skipped = skip_to_face_update(&state->ball_x, &state->ball_y, state->vel_x, &state->vel_y);
+    if (skipped < 0) {
+        // the ball is behind the paddle already
+        state->searching = 0;
+        state->ticks_left = 0;
+        return;
+    }
+    state->ticks_left = skipped + 1;
+    // the ball crosses the line of the face at most |vel_y| from ball_y, the paddle hits it when it reaches there
+    fixed_t reach = state->vel_y < 0 ? -state->vel_y : state->vel_y;
+    state->next_y = FIXED_TO_INT(state->ball_y - reach) - PADDLE_HEIGHT;
+    state->last_y = FIXED_TO_INT(state->ball_y + reach) + BALL_SIZE + 1;
+    if (state->next_y < LIVES_FONT_SIZE) state->next_y = LIVES_FONT_SIZE;
+    if (state->last_y > LCD_HEIGHT - PADDLE_HEIGHT) state->last_y = LCD_HEIGHT - PADDLE_HEIGHT;
+    state->best_score = -1;
+    state->searching = 1;
+}
+
+/**
+ * Try the candidate paddle positions one by one until all are tried or EXPERT_AI_CANDIDATES of them were played. \n
+ * When all are tried, the best one becomes the target of the paddle, or the place of the ball if none returns it.
+ * @param is_right 0 if the AI controls the left paddle, 1 if the AI controls the right paddle
+ * @param game_data the state of the game given to the AI
+ * @param state the state of the paddle
+ */
+void search_returns(char is_right, struct game_data* game_data, struct expert_ai_state* state) {
+    int paddle_y = is_right ? game_data->paddle_right_pos : game_data->paddle_left_pos;
+    int budget = EXPERT_AI_CANDIDATES;
+    while (state->next_y <= state->last_y) {
+        int candidate = state->next_y++;
+        if (!can_reach(paddle_y, candidate, state->ticks_left)) continue;
+        int score = score_return(is_right, game_data, state, candidate);
+        if (score > state->best_score) {
+            state->best_score = score;
+            state->best_y = candidate;
+        }
+        if (state->next_y <= state->last_y && --budget == 0) return;
+    }
+    state->searching = 0;
+    if (state->best_score >= 0) {
+        state->target_paddle_y = state->best_y;
+    } else {
+        state->target_paddle_y = FIXED_ROUND(state->ball_y) - (PADDLE_HEIGHT - BALL_SIZE) / 2;
+    }
+}
+
+/**
+ * Determine whether the paddle moved by the AI gets exactly to the given position in time.
+ * @param from the current position of the paddle
+ * @param to the desired position of the paddle
+ * @param ticks the number of moves left
+ * @return 1 if the position can be reached, 0 otherwise
+ */
+char can_reach(int from, int to, int ticks) {
+    int distance = to > from ? to - from : from - to;
+    if (distance > ticks * PADDLE_SPEED_KEY) return 0;
+    // the paddle moves by whole steps, only at the edges of the court it stops in between
+    return distance % PADDLE_SPEED_KEY == 0 || to == LIVES_FONT_SIZE || to == LCD_HEIGHT - PADDLE_HEIGHT;
+}
+
+/**
+ * Play the return of the ball from the given paddle position with the physics of the game. \n
+ * The score grows with the distance the opponent has to travel to reach the returned ball,
+ * among equal distances the sooner the ball gets to the opponent, the higher the score.
+ * @param is_right 0 if the AI controls the left paddle, 1 if the AI controls the right paddle
+ * @param game_data the state of the game given to the AI
+ * @param state the state of the paddle
+ * @param paddle_y the candidate paddle position
+ * @return the score of the return, -1 if the paddle misses the ball there
+ */
+int score_return(char is_right, struct game_data* game_data, struct expert_ai_state* state, int paddle_y) {
+    fixed_t x = state->ball_x, y = state->ball_y, vel_x = state->vel_x, vel_y = state->vel_y;
+    int opponent_y = is_right ? game_data->paddle_left_pos : game_data->paddle_right_pos;
+    int paddles[2];
+    paddles[(int)is_right] = paddle_y;
+    paddles[!is_right] = opponent_y;
+    struct contact contacts[MAX_CONTACTS];
+    int count = sweep_ball(&x, &y, &vel_x, &vel_y, paddles, FIXED_ROUND(vel_x < 0 ? -vel_x : vel_x), contacts);
+    char hit = 0;
+    for (int i = 0; i < count; i++) {
+        if (contacts[i].surface == SURFACE_PADDLE_FACE && contacts[i].side == is_right) hit = 1;
+    }
+    if (!hit || contacts[count - 1].surface == SURFACE_GOAL) return -1;
+    int ticks;
+    fixed_t at = predict_face_y(x, y, vel_x, vel_y, &ticks);
+    // the opponent hits the ball from the paddle positions at - PADDLE_HEIGHT to at + BALL_SIZE
+    int low = FIXED_TO_INT(at - INT_TO_FIXED(PADDLE_HEIGHT) + FIXED_ONE - 1);
+    int high = FIXED_TO_INT(at) + BALL_SIZE;
+    int distance = opponent_y < low ? low - opponent_y : opponent_y > high ? opponent_y - high : 0;
+    int opponent_ticks = state->ticks_left + ticks;
+    if (opponent_ticks > 1023) opponent_ticks = 1023;
+    return distance * 1024 + 1023 - opponent_ticks;
+}
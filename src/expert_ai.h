@@ -0,0 +1,33 @@
+#ifndef EXPERT_AI_H
+#define EXPERT_AI_H
+
+/** @file
+ * This is an implementation of ai_interface.h
+ */
+
+#include "ai_interface.h"
+
+/* the number of candidates the AI may try in one update, an unfinished search continues in the next update \n
+ * it is a number and not a time, so the games do not depend on the speed of the computer,
+ * a candidate takes about 0.2 us on a desktop computer and a few times more on the board */
+#define EXPERT_AI_CANDIDATES (32)
+
+/**
+ * This funciton is called every game update to determine the AI's movement. \n
+ * It is the move function of the AI, see ai_interface.h.
+ * @param is_right 0 if the AI controls the left paddle, \n
+ *                 1 if the AI controls the right paddle
+ * @param game_data a structure containing all information about the state of the game
+ * @param state the state the AI keeps between updates for this paddle
+ * @param seed the state of the random numbers of the game, to be used with rand_r
+ * @return -1 for moving up \n
+ *          0 for not moving \n
+ *          1 for moving down
+ * @see game.h for struct game_data and struct ai_state
+ */
+char expert_ai_move(char is_right, struct game_data game_data, struct ai_state* state, unsigned int* seed);
+
+/** the AI searching for the return the opponent can reach the hardest */
+extern const ai_interface_t expert_ai;
+
+#endif
@@ -0,0 +1,30 @@
+/** @file
+ * Fixed-point numbers with 16 integer and 16 fractional bits (Q16.16) used for the ball physics. \n
+ * Only integer operations are used, so the game gives the same results on every platform. \n
+ * Products are computed in 64 bits, divisions truncate towards zero and conversions to pixels round down
+ * (right shift of negative numbers is arithmetic with gcc on both x86 and ARM).
+ */
+
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <stdint.h>
+
+typedef int32_t fixed_t;
+
+#define FIXED_SHIFT (16)
+#define FIXED_ONE ((fixed_t)1 << FIXED_SHIFT)
+#define FIXED_HALF (FIXED_ONE / 2)
+
+// whole number to fixed-point
+#define INT_TO_FIXED(i) ((fixed_t)(i) * FIXED_ONE)
+// fixed-point to whole number, rounded down
+#define FIXED_TO_INT(f) ((int)((f) >> FIXED_SHIFT))
+// fixed-point to the nearest whole number
+#define FIXED_ROUND(f) FIXED_TO_INT((f) + FIXED_HALF)
+// a * b
+#define FIXED_MUL(a, b) ((fixed_t)(((int64_t)(a) * (b)) >> FIXED_SHIFT))
+// a * b / c without losing precision in the product, the result has the unit of a * b / c
+#define FIXED_MUL_DIV(a, b, c) ((fixed_t)((int64_t)(a) * (b) / (c)))
+
+#endif
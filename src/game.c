@@ -7,49 +7,52 @@
 #include "mzapo_regs.h"
 #include "log.h"
 #include "graphics.h"
+#include "menu_events.h"
+#include "render_thread.h"
+#include "tick_scheduler.h"
+#include "replay.h"
+#include "collision.h"
 #include <time.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
-#include "basic_ai.h"
-#include "better_ai.h"
-
-void init_game(void);
-void init_data(void);
-void update_loop(void);
-void update(void);
-void update_paddles(void);
-void update_player_paddle(char is_right, char last_key, int knob_diff);
-void update_ai_paddle(char is_right);
-void move_ai_paddle(char is_right, char dir);
-void move_paddle(char is_right, int distance);
-char update_ball(void);
-void check_ball_top_bot_edge_collision(void);
-void check_ball_paddle_collision(void);
-void on_hit_change_ball_vel_y(int paddle_y, int ball_y, int overshoot);
-char check_ball_left_right_edge_collision(void);
-void on_ball_left_right_edge_collision(char side);
-char update_lives(char ball_ret);
-void reset_ball(void);
-void move_led_line(void);
-void hit_blink(char is_right);
-void ball_loss_blink(char is_right);
-void update_diodes(void);
-void post_game_screen(void);
-
-static int ball_speed;
-static struct game_data data;
-static int score;
-static settings_t* game_settings;
-static char game_running;
-static unsigned char* memory;
-static knobs_t* input_knobs;
-static char last_key[2];
-static int hit_blink_left_countdown;
-static int hit_blink_right_countdown;
-static int ball_loss_blink_left_countdown;
-static int ball_loss_blink_right_countdown;
+#include "ai_registry.h"
+
+void init_data(game_ctx_t* ctx);
+void update_loop(game_ctx_t* ctx, knobs_t* knobs, replay_writer_t* recorder);
+replay_writer_t* start_recording(game_ctx_t* ctx, replay_writer_t* writer);
+struct tick_input read_tick_input(knobs_t* knobs);
+void update_paddles(game_ctx_t* ctx, struct tick_input* input);
+void update_player_paddle(game_ctx_t* ctx, char is_right, char key, int knob_diff);
+void init_ai_state(game_ctx_t* ctx, char is_right);
+void destroy_ai_state(game_ctx_t* ctx, char is_right);
+void refocus_ai_state(game_ctx_t* ctx, char is_right);
+void update_ai_paddle(game_ctx_t* ctx, char is_right);
+struct game_data ai_view(game_ctx_t* ctx, char is_right);
+int choose_focus_ball(struct balls* balls, char is_right);
+void move_ai_paddle(game_ctx_t* ctx, char is_right, char dir);
+void move_paddle(game_ctx_t* ctx, char is_right, int distance);
+char update_ball(game_ctx_t* ctx);
+char on_ball_contact(game_ctx_t* ctx, struct contact* contact);
+void update_balls(game_ctx_t* ctx);
+void on_ball_left_right_edge_collision(game_ctx_t* ctx, char side, int ball);
+char update_lives(game_ctx_t* ctx, char looser);
+void reset_ball(game_ctx_t* ctx);
+void reset_multi_ball(game_ctx_t* ctx, int ball);
+void move_led_line(game_ctx_t* ctx);
+void light_diode(game_ctx_t* ctx, char is_right, uint32_t color);
+void count_hit(game_ctx_t* ctx, char is_right);
+void count_ball_loss(game_ctx_t* ctx, char is_right);
+void hit_blink(game_ctx_t* ctx, char is_right);
+void ball_loss_blink(game_ctx_t* ctx, char is_right);
+void update_diodes(game_ctx_t* ctx);
+void game_log(game_ctx_t* ctx, char* msg);
+void post_game_screen(game_ctx_t* ctx);
+
+static char* record_path = NULL;
+static int recorded_games = 0;
 
 /**
  * Initialize and start the game.
@@ -60,137 +63,280 @@ static int ball_loss_blink_right_countdown;
  * @return score if one player is human and one is bot, -1 otherwise
  */
 int start_game(unsigned char* membase, unsigned char* lcd_membase, knobs_t* knobs, settings_t* settings) {
-    memory = membase;
-    input_knobs = knobs;
-    game_settings = settings;
+    game_ctx_t ctx;
     led_settings_t* led_settings = init_led_settings(membase);
-    init_game();
+    init_game_ctx(&ctx, settings, membase, rand());
+    game_log(&ctx, "game initialized");
+    replay_writer_t writer;
+    replay_writer_t* recorder = start_recording(&ctx, &writer);
     init_view(lcd_membase, settings);
-    update_loop();
+    start_render_thread(RENDER_THREAD_CPU);
+    update_loop(&ctx, knobs, recorder);
+    stop_render_thread();
+    if (recorder && close_replay_writer(recorder, &ctx)) print_log(LOG_HEAD_GAME, "ERROR: replay not written");
     restore_led_settings(membase, led_settings);
-    if ((settings->left == PLAYER && settings->right == PLAYER) || (settings->left == BOT && settings->right == BOT)) {
+    if (ctx.data.lives_left >= 0) {
         uint16_t frame[LCD_HEIGHT * LCD_WIDTH];
+        int max_lives = ctx.balls.count ? MULTI_BALL_LIVES : INITIAL_LIVES;
         for (int i = 0; i < LCD_HEIGHT * LCD_WIDTH; i++) frame[i] = BACKGROUND;
-        create_result_page(data.lives_left, data.lives_right, INITIAL_LIVES, settings->paddlecolors[data.lives_left ? 0 : 1], frame, lcd_membase);
+        create_result_page(ctx.data.lives_left, ctx.data.lives_right, max_lives, settings->paddlecolors[ctx.data.lives_left ? 0 : 1], frame, lcd_membase);
         show_and_wait(frame, lcd_membase, knobs);
     }
     destroy_led_settings(led_settings);
-    return score;
+    destroy_game_ctx(&ctx);
+    return ctx.score;
 }
 
 /**
- * Initialize the game.
+ * Record the input of every following game into a replay file. \n
+ * Game number n is recorded into the file "path.n".
+ * @param path the beginning of the names of the replay files, NULL to stop recording
  */
-void init_game(void) {
-    init_data();
-    light_left_diode(memory, NORMAL_LED_COLOR);
-    light_right_diode(memory, NORMAL_LED_COLOR);
-    last_key[0] = 0;
-    last_key[1] = 0;
-    hit_blink_left_countdown = 0;
-    hit_blink_right_countdown = 0;
-    ball_loss_blink_left_countdown = 0;
-    ball_loss_blink_right_countdown = 0;
-    if ((game_settings->left == PLAYER && game_settings->right == BOT) || (game_settings->left == BOT && game_settings->right == PLAYER)) {
-        score = 0;
+void record_games(char* path) {
+    record_path = path;
+    recorded_games = 0;
+}
+
+/**
+ * Open the replay file of the game if the games are being recorded.
+ * @param ctx the context of the game that has just been initialized
+ * @param writer the writer to be used
+ * @return the writer, NULL if the game is not recorded
+ */
+replay_writer_t* start_recording(game_ctx_t* ctx, replay_writer_t* writer) {
+    if (!record_path) return NULL;
+    if (ctx->balls.count) {
+        game_log(ctx, "multi-ball games are not recorded");
+        return NULL;
+    }
+    char path[256];
+    replay_header_t header;
+    snprintf(path, sizeof(path), "%s.%d", record_path, ++recorded_games);
+    replay_header_from_ctx(&header, ctx);
+    if (open_replay_writer(writer, path, &header)) {
+        print_log(LOG_HEAD_GAME, "ERROR: replay file not created");
+        return NULL;
+    }
+    game_log(ctx, "recording the game");
+    return writer;
+}
+
+/**
+ * Initialize a game context.
+ * @param ctx the context to be initialized
+ * @param settings contains the settings from the menu, it is only read and must outlive the context
+ * @param membase the base of the memory of the system, NULL for a game without leds
+ * @param seed the seed of the random numbers of this game
+ */
+void init_game_ctx(game_ctx_t* ctx, settings_t* settings, unsigned char* membase, unsigned int seed) {
+    memset(ctx, 0, sizeof(game_ctx_t));
+    ctx->settings = settings;
+    ctx->membase = membase;
+    ctx->seed = seed;
+    ctx->initial_seed = seed;
+    ctx->logging = LOG_GAME;
+    ctx->led_line = 1;
+    ctx->ai[0] = settings->ai;
+    ctx->ai[1] = settings->ai;
+    init_ai_state(ctx, 0);
+    init_ai_state(ctx, 1);
+    ctx->stats.winner = -1;
+    init_data(ctx);
+    light_diode(ctx, 0, NORMAL_LED_COLOR);
+    light_diode(ctx, 1, NORMAL_LED_COLOR);
+    if (!ctx->balls.count && ((settings->left == PLAYER && settings->right == BOT) || (settings->left == BOT && settings->right == PLAYER))) {
+        ctx->score = 0;
     } else {
-        score = -1;
+        ctx->score = -1;
+    }
+    ctx->running = 1;
+}
+
+/**
+ * Release everything the AIs of the paddles acquired, the context can be initialized again afterwards.
+ * @param ctx the context of the game
+ */
+void destroy_game_ctx(game_ctx_t* ctx) {
+    destroy_ai_state(ctx, 0);
+    destroy_ai_state(ctx, 1);
+}
+
+/**
+ * Replace the AI of a paddle, the new AI starts with a fresh state.
+ * @param ctx the context of the game
+ * @param is_right 0 for the left paddle, 1 for the right one
+ * @param ai the id of the AI in the registry of ai_registry.h
+ */
+void set_game_ai(game_ctx_t* ctx, char is_right, int ai) {
+    destroy_ai_state(ctx, is_right);
+    ctx->ai[(int)is_right] = ai;
+    init_ai_state(ctx, is_right);
+}
+
+/**
+ * Give the AI of a paddle a fresh state.
+ * @param ctx the context of the game
+ * @param is_right 0 for the left paddle, 1 for the right one
+ */
+void init_ai_state(game_ctx_t* ctx, char is_right) {
+    const ai_interface_t* ai = get_ai(ctx->ai[(int)is_right]);
+    memset(&ctx->ai_state[(int)is_right], 0, sizeof(struct ai_state));
+    if (ai && ai->init) ai->init(&ctx->ai_state[(int)is_right], is_right);
+}
+
+/**
+ * Let the AI of a paddle release its state.
+ * @param ctx the context of the game
+ * @param is_right 0 for the left paddle, 1 for the right one
+ */
+void destroy_ai_state(game_ctx_t* ctx, char is_right) {
+    const ai_interface_t* ai = get_ai(ctx->ai[(int)is_right]);
+    if (ai && ai->destroy) ai->destroy(&ctx->ai_state[(int)is_right]);
+}
+
+/**
+ * Prepare the state of the AI of a paddle for a new ball to follow,
+ * AIs without their own refocus start from a new state.
+ * @param ctx the context of the game
+ * @param is_right 0 for the left paddle, 1 for the right one
+ */
+void refocus_ai_state(game_ctx_t* ctx, char is_right) {
+    const ai_interface_t* ai = get_ai(ctx->ai[(int)is_right]);
+    if (ai && ai->refocus) {
+        ai->refocus(&ctx->ai_state[(int)is_right], is_right);
+        return;
     }
-    if (LOG_GAME) print_log(LOG_HEAD_GAME, "game initialized");
+    destroy_ai_state(ctx, is_right);
+    init_ai_state(ctx, is_right);
 }
 
 /**
  * Initialize game data.
+ * @param ctx the context of the game
  */
-void init_data(void) {
-    switch (game_settings->difficulty) {
+void init_data(game_ctx_t* ctx) {
+    switch (ctx->settings->difficulty) {
         case EASY:
-            ball_speed = BALL_SPEED_EASY;
+            ctx->ball_speed = BALL_SPEED_EASY;
             break;
         case MEDIUM:
-            ball_speed = BALL_SPEED_MEDIUM;
+            ctx->ball_speed = BALL_SPEED_MEDIUM;
             break;
         case HARD:
-            ball_speed = BALL_SPEED_HARD;
+            ctx->ball_speed = BALL_SPEED_HARD;
             break;
         default:
-            ball_speed = 0;
-            if (LOG_GAME) print_log(LOG_HEAD_GAME, "ERROR: wrong difficulty level in settings");
+            ctx->ball_speed = 0;
+            game_log(ctx, "ERROR: wrong difficulty level in settings");
     }
     int paddle_init_pos = LIVES_FONT_SIZE + (LCD_HEIGHT - LIVES_FONT_SIZE - PADDLE_HEIGHT) / 2;
-    data.paddle_left_pos = paddle_init_pos;
-    data.paddle_right_pos = paddle_init_pos;
-    if ((game_settings->left == PLAYER && game_settings->right == PLAYER) || (game_settings->left == BOT && game_settings->right == BOT)) {
-        data.lives_left = INITIAL_LIVES;
-        data.lives_right = INITIAL_LIVES;
+    ctx->data.paddle_left_pos = paddle_init_pos;
+    ctx->data.paddle_right_pos = paddle_init_pos;
+    if (ctx->settings->ball_count > 1) {
+        ctx->data.lives_left = MULTI_BALL_LIVES;
+        ctx->data.lives_right = MULTI_BALL_LIVES;
+    } else if ((ctx->settings->left == PLAYER && ctx->settings->right == PLAYER) || (ctx->settings->left == BOT && ctx->settings->right == BOT)) {
+        ctx->data.lives_left = INITIAL_LIVES;
+        ctx->data.lives_right = INITIAL_LIVES;
     } else {
-        data.lives_left = -1;
-        data.lives_right = -1;
+        ctx->data.lives_left = -1;
+        ctx->data.lives_right = -1;
+    }
+    reset_ball(ctx);
+    if (ctx->settings->ball_count > 1) {
+        ctx->balls.count = ctx->settings->ball_count < MAX_BALLS ? ctx->settings->ball_count : MAX_BALLS;
+        for (int i = 0; i < ctx->balls.count; i++) reset_multi_ball(ctx, i);
     }
-    reset_ball();
 }
 
 /**
  * Handles the game update loop with set updates per second. \n
- * Calls update() to update the game data and update_view() to update the view.
- */
-void update_loop(void) {
-    int clocks_per_update = CLOCKS_PER_SEC / UPDATES_PER_SECOND;
-    clock_t last, now;
-    last = clock();
-    int delta = 0;
-    game_running = 1;
-    if (LOG_GAME) print_log(LOG_HEAD_GAME, "update loop initialized");
-    while(game_running) {
-        now = clock();
-        delta += now - last;
-        last = now;
-        if (delta >= clocks_per_update) {
-            delta -= clocks_per_update;
-            update();
-            update_view(data, score);
+ * Sleeps until the next update is due, reads the input of the players, calls update() to update the game data
+ * and hands the new state to the render thread. \n
+ * After a late wake up the missed updates are run at once, up to MAX_CATCH_UP_UPDATES.
+ * @param ctx the context of the game
+ * @param knobs contains information about the input from the knobs
+ * @param recorder the input of every update is recorded by it, NULL for no recording
+ */
+void update_loop(game_ctx_t* ctx, knobs_t* knobs, replay_writer_t* recorder) {
+    tick_scheduler_t scheduler;
+    init_tick_scheduler(&scheduler, UPDATES_PER_SECOND, MAX_CATCH_UP_UPDATES);
+    game_log(ctx, "update loop initialized");
+    while(ctx->running) {
+        int ticks = wait_for_ticks(&scheduler);
+        for (int i = 0; i < ticks && ctx->running; i++) {
+            struct tick_input input = read_tick_input(knobs);
+            if (recorder) record_tick(recorder, ctx, input);
+            update(ctx, input);
         }
+        publish_view(ctx->data, ctx->balls.count ? &ctx->balls : NULL, ctx->score);
+    }
+    if (ctx->logging) {
+        char str[80];
+        sprintf(str, "%lu updates, %lu overruns, %lu updates dropped", scheduler.ticks, scheduler.overruns, scheduler.dropped_ticks);
+        print_log(LOG_HEAD_GAME, str);
     }
 }
 
 /**
- * Check for user input, update game object positions, check for collisions.
+ * Read the keys pressed since the last update and the movement of the knobs.
+ * @param knobs contains information about the input from the knobs
+ * @return the input of both players for the next update
  */
-void update(void) {
-    move_led_line();
-    update_paddles();
-    char ball_ret = update_ball();
-    on_ball_left_right_edge_collision(ball_ret);
-    update_diodes();
+struct tick_input read_tick_input(knobs_t* knobs) {
+    struct tick_input tick_input;
+    struct input input = get_input();
+    get_knob_value(knobs);
+    tick_input.key_dir[0] = 0;
+    if (input.left_up && !input.left_down) tick_input.key_dir[0] = -1;
+    if (input.left_down && !input.left_up) tick_input.key_dir[0] = 1;
+    tick_input.key_dir[1] = 0;
+    if (input.right_up && !input.right_down) tick_input.key_dir[1] = -1;
+    if (input.right_down && !input.right_up) tick_input.key_dir[1] = 1;
+    tick_input.knob_diff[0] = get_knob_movement(knobs, RED_K);
+    tick_input.knob_diff[1] = get_knob_movement(knobs, BLUE_K);
+    return tick_input;
 }
 
 /**
- * Update the positions of the paddles according to the user input or AI decisions.
+ * Update the game: move the paddles, move the ball and check for collisions.
+ * @param ctx the context of the game
+ * @param input the input of the players for this update
+ * @return 1 if the game continues, 0 if it has ended
  */
-void update_paddles(void) {
-    struct input input = get_input();
-    get_knob_value(input_knobs);
-    if (game_settings->left == PLAYER) {
-        char paddle_dir = 0;
-        if (input.left_up && !input.left_down) paddle_dir = -1;
-        if (input.left_down && !input.left_up) paddle_dir = 1;
-        update_player_paddle(0, paddle_dir, get_knob_movement(input_knobs, RED_K));
+char update(game_ctx_t* ctx, struct tick_input input) {
+    if (!ctx->running) return 0;
+    ctx->stats.ticks++;
+    move_led_line(ctx);
+    update_paddles(ctx, &input);
+    if (ctx->balls.count) {
+        update_balls(ctx);
     } else {
-        update_ai_paddle(0);
+        on_ball_left_right_edge_collision(ctx, update_ball(ctx), 0);
     }
-    if (game_settings->right == PLAYER) {
-        char paddle_dir = 0;
-        if (input.right_up && !input.right_down) paddle_dir = -1;
-        if (input.right_down && !input.right_up) paddle_dir = 1;
-        update_player_paddle(1, paddle_dir, get_knob_movement(input_knobs, BLUE_K));
-    } else {
-        update_ai_paddle(1);
+    update_diodes(ctx);
+    return ctx->running;
+}
+
+/**
+ * Update the positions of the paddles according to the user input or AI decisions.
+ * @param ctx the context of the game
+ * @param input the input of the players for this update
+ */
+void update_paddles(game_ctx_t* ctx, struct tick_input* input) {
+    for (int side = 0; side < 2; side++) {
+        if ((side ? ctx->settings->right : ctx->settings->left) == PLAYER) {
+            update_player_paddle(ctx, side, input->key_dir[side], input->knob_diff[side]);
+        } else {
+            update_ai_paddle(ctx, side);
+        }
     }
 }
 
 
 /**
  * Move the paddle accordingly to the given inputs from the keyboard and the knob.
+ * @param ctx the context of the game
  * @param is_right specifies which paddle is to be updated (0 for left, 1 for right)
  * @param key -1 if the key for "UP" has been pressed since the last update \n
  *             1 if the key for "DOWN" has been pressed since the last update \n
@@ -198,363 +344,456 @@ void update_paddles(void) {
  * @param knob_diff describes how has the knob moved relatively to the position upon previous update \n
  *                  <0 for counter-clockwise, >0 for clockwise, 0 for no movement
  */
-void update_player_paddle(char is_right, char key, int knob_diff) {
+void update_player_paddle(game_ctx_t* ctx, char is_right, char key, int knob_diff) {
+    char* last_key = &ctx->last_key[(int)is_right];
     if (knob_diff) {
-        last_key[(int)is_right] = 0;
-        move_paddle(is_right, (is_right ? -1 : 1) * knob_diff * PADDLE_SPEED_KNOB);
+        *last_key = 0;
+        move_paddle(ctx, is_right, (is_right ? -1 : 1) * knob_diff * PADDLE_SPEED_KNOB);
     } else {
-        if (key) last_key[(int)is_right] = key;
-        if (last_key[(int)is_right] == (char)-1) {
-            move_paddle(is_right, -PADDLE_SPEED_KEY);
-        } else if (last_key[(int)is_right] == (char)1) {
-            move_paddle(is_right, PADDLE_SPEED_KEY);
+        if (key) *last_key = key;
+        if (*last_key == (char)-1) {
+            move_paddle(ctx, is_right, -PADDLE_SPEED_KEY);
+        } else if (*last_key == (char)1) {
+            move_paddle(ctx, is_right, PADDLE_SPEED_KEY);
         }
     }
 }
 
 /**
  * Move the paddle according to the direction given by the AI.
+ * @param ctx the context of the game
  * @param is_right specifies which paddle is to be updated (0 for left, 1 for right)
  */
-void update_ai_paddle(char is_right) {
-    char c;
-    switch (game_settings->ai) {
-        case DUMB_AI:
-            c = basic_ai_move(is_right, data);
-            break;
-        case SMARTER_AI:
-            c = better_ai_move(is_right, data);
-            break;
-        default:
-            if (LOG_GAME) print_log(LOG_HEAD_GAME, "ERROR: AI id number not recognized");
-            return;
+void update_ai_paddle(game_ctx_t* ctx, char is_right) {
+    const ai_interface_t* ai = get_ai(ctx->ai[(int)is_right]);
+    if (!ai) {
+        game_log(ctx, "ERROR: AI id number not recognized");
+        return;
+    }
+    struct game_data view = ai_view(ctx, is_right);
+    move_ai_paddle(ctx, is_right, ai->move(is_right, view, &ctx->ai_state[(int)is_right], &ctx->seed));
+}
+
+/**
+ * The state of the game as seen by the AI. \n
+ * In the multi-ball mode the AI sees only the ball it follows, a new ball makes it plan its move again.
+ * @param ctx the context of the game
+ * @param is_right 0 for the AI of the left paddle, 1 for the right one
+ * @return the game data with the ball the AI should play
+ */
+struct game_data ai_view(game_ctx_t* ctx, char is_right) {
+    struct game_data view = ctx->data;
+    struct balls* balls = &ctx->balls;
+    if (!balls->count) return view;
+    int ball = choose_focus_ball(balls, is_right);
+    if (ball != ctx->focus_ball[(int)is_right]) {
+        ctx->focus_ball[(int)is_right] = ball;
+        refocus_ai_state(ctx, is_right);
+    }
+    view.ball_pos_x = balls->pos_x[ball];
+    view.ball_pos_y = balls->pos_y[ball];
+    view.ball_vel_x = balls->vel_x[ball];
+    view.ball_vel_y = balls->vel_y[ball];
+    return view;
+}
+
+/**
+ * Choose the ball which reaches the paddle first, or the closest one if no ball is coming towards the paddle.
+ * @param balls the balls of the game
+ * @param is_right 0 for the left paddle, 1 for the right one
+ * @return the index of the chosen ball
+ */
+int choose_focus_ball(struct balls* balls, char is_right) {
+    const fixed_t face = is_right ? INT_TO_FIXED(LCD_WIDTH - PADDLE_WIDTH - BALL_SIZE) : INT_TO_FIXED(PADDLE_WIDTH);
+    int best = -1, closest = 0;
+    fixed_t best_distance = 0, best_speed = 1, closest_distance = INT32_MAX;
+    for (int i = 0; i < balls->count; i++) {
+        fixed_t distance = is_right ? face - balls->pos_x[i] : balls->pos_x[i] - face;
+        fixed_t speed = is_right ? balls->vel_x[i] : -balls->vel_x[i];
+        if (distance < 0) distance = 0;
+        if (distance < closest_distance) {
+            closest_distance = distance;
+            closest = i;
+        }
+        // the time to the paddle is distance / speed, compared without dividing
+        if (speed > 0 && (best < 0 || (int64_t)distance * best_speed < (int64_t)best_distance * speed)) {
+            best = i;
+            best_distance = distance;
+            best_speed = speed;
+        }
     }
-    move_ai_paddle(is_right, c);
+    return best >= 0 ? best : closest;
 }
 
 /**
  * Move the paddle according to the direction given by the AI.
+ * @param ctx the context of the game
  * @param is_right 0 for left paddle, 1 for right paddle
  * @param dir the direction given by the AI
  */
-void move_ai_paddle(char is_right, char dir) {
+void move_ai_paddle(game_ctx_t* ctx, char is_right, char dir) {
     if (dir == (char)-1) {
-        move_paddle(is_right, -PADDLE_SPEED_KEY);
+        move_paddle(ctx, is_right, -PADDLE_SPEED_KEY);
     } else if (dir == (char)1) {
-        move_paddle(is_right, PADDLE_SPEED_KEY);
+        move_paddle(ctx, is_right, PADDLE_SPEED_KEY);
     }
 }
 
 /**
  * Move a paddle by the given distance.
+ * @param ctx the context of the game
  * @param is_right set to 0 to move the left paddle, set to 1 to move the right paddle
  * @param distance the distance by which the paddle is to be moved; \n
  *                 negative values for upwards direction, positive values for downwards direction
  */
-void move_paddle(char is_right, int distance) {
-    if (is_right) {
-        data.paddle_right_pos += distance;
-        if (data.paddle_right_pos < LIVES_FONT_SIZE) data.paddle_right_pos = LIVES_FONT_SIZE;
-        if (data.paddle_right_pos > LCD_HEIGHT - PADDLE_HEIGHT) data.paddle_right_pos = LCD_HEIGHT - PADDLE_HEIGHT;
-    } else {
-        data.paddle_left_pos += distance;
-        if (data.paddle_left_pos < LIVES_FONT_SIZE) data.paddle_left_pos = LIVES_FONT_SIZE;
-        if (data.paddle_left_pos > LCD_HEIGHT - PADDLE_HEIGHT) data.paddle_left_pos = LCD_HEIGHT - PADDLE_HEIGHT;
-    }
+void move_paddle(game_ctx_t* ctx, char is_right, int distance) {
+    int* paddle_pos = is_right ? &ctx->data.paddle_right_pos : &ctx->data.paddle_left_pos;
+    *paddle_pos += distance;
+    if (*paddle_pos < LIVES_FONT_SIZE) *paddle_pos = LIVES_FONT_SIZE;
+    if (*paddle_pos > LCD_HEIGHT - PADDLE_HEIGHT) *paddle_pos = LCD_HEIGHT - PADDLE_HEIGHT;
 }
 
 /**
- * Check ball collisions and update the ball.
+ * Move the ball along its path of one update and handle all its contacts on the way.
+ * @param ctx the context of the game
  * @return -1 if the ball touches the left edge of the game court, \n
  *          1 if the ball touches the right edge of the game court, \n
  *          0 otherwise
+ * @see collision.h for the swept collision of the ball
  */
-char update_ball(void) {
-    data.ball_pos_y += data.ball_vel_y;
-    data.ball_pos_x += data.ball_vel_x;
-    check_ball_top_bot_edge_collision();
-    check_ball_paddle_collision();
-    return check_ball_left_right_edge_collision();
+char update_ball(game_ctx_t* ctx) {
+    struct game_data* data = &ctx->data;
+    struct contact contacts[MAX_CONTACTS];
+    int paddle_y[2] = {data->paddle_left_pos, data->paddle_right_pos};
+    int count = sweep_ball(&data->ball_pos_x, &data->ball_pos_y, &data->ball_vel_x, &data->ball_vel_y, paddle_y, ctx->ball_speed, contacts);
+    char side = 0;
+    for (int i = 0; i < count; i++) side = on_ball_contact(ctx, &contacts[i]);
+    return side;
 }
 
 /**
- * Check ball collisions with the top and bottom edges of the game court and invert the y velocity of the ball.
+ * Handle one contact of the ball: blink and count paddle hits, add to the score and log the contact.
+ * @param ctx the context of the game
+ * @param contact the contact of the ball
+ * @return -1 if the ball touched the left edge of the game court, \n
+ *          1 if the ball touched the right edge of the game court, \n
+ *          0 otherwise
  */
-void check_ball_top_bot_edge_collision(void) {
-    if (data.ball_pos_y < LIVES_FONT_SIZE) {
-        data.ball_pos_y = 2 * LIVES_FONT_SIZE - data.ball_pos_y;
-        data.ball_vel_y = -data.ball_vel_y;
-        if (LOG_GAME) print_log(LOG_HEAD_GAME, "top wall hit");
-    }
-    if (data.ball_pos_y > LCD_HEIGHT - BALL_SIZE) {
-        data.ball_pos_y = 2 * LCD_HEIGHT - 2 * BALL_SIZE - data.ball_pos_y;
-        data.ball_vel_y = -data.ball_vel_y;
-        if (LOG_GAME) print_log(LOG_HEAD_GAME, "bot wall hit");
+char on_ball_contact(game_ctx_t* ctx, struct contact* contact) {
+    char is_right = contact->side;
+    switch (contact->surface) {
+        case SURFACE_WALL_TOP:
+            game_log(ctx, "top wall hit");
+            break;
+        case SURFACE_WALL_BOTTOM:
+            game_log(ctx, "bot wall hit");
+            break;
+        case SURFACE_PADDLE_FACE:
+            hit_blink(ctx, is_right);
+            count_hit(ctx, is_right);
+            if (ctx->score >= 0 && (is_right ? ctx->settings->right : ctx->settings->left) == PLAYER) ctx->score++;
+            game_log(ctx, is_right ? "right paddle hit" : "left paddle hit");
+            break;
+        case SURFACE_PADDLE_TOP:
+        case SURFACE_PADDLE_BOTTOM:
+            // the ball is behind the paddle and is going to be lost anyway, so this is not a hit
+            game_log(ctx, is_right ? "right paddle edge hit" : "left paddle edge hit");
+            break;
+        case SURFACE_GOAL:
+            game_log(ctx, is_right ? "right player lost" : "left player lost");
+            return is_right ? 1 : -1;
     }
+    return 0;
 }
 
 /**
- * Check for ball collisions with the paddles,
- * move the ball to the correct x coordinate and invert the x velocity of the ball accordingly. \n
- * Call on_hit_change_ball_vel_y to handle y coordinate correction and y velocity update.
+ * Move all balls of the multi-ball mode and handle their contacts. \n
+ * Balls which stay between the paddle faces can only bounce off the walls, they are moved in one pass over the arrays.
+ * Only the balls which reach the paddles or the edges of the court go through the swept collision.
+ * Wall hits of the balls between the paddles are not logged, there are too many of them.
+ * @param ctx the context of the game
  */
-void check_ball_paddle_collision(void) {
-    static int left_limit = PADDLE_WIDTH;
-    static int right_limit = LCD_WIDTH - PADDLE_WIDTH - BALL_SIZE;
-    int previous_y = data.ball_pos_y - data.ball_vel_y;
-    int previous_x = data.ball_pos_x - data.ball_vel_x;
-    if (data.ball_pos_x < left_limit && previous_x >= left_limit) {
-        double ball_dir = data.ball_vel_y / data.ball_vel_x;
-        int hit_y = (double)previous_y + (double)(left_limit - previous_x) * ball_dir + 0.5;
-        if ((data.paddle_left_pos > hit_y - PADDLE_HEIGHT) && (data.paddle_left_pos < hit_y + BALL_SIZE)) {
-            on_hit_change_ball_vel_y(data.paddle_left_pos, hit_y, left_limit - data.ball_pos_x);
-            data.ball_pos_x = 2 * left_limit - data.ball_pos_x;
-            data.ball_vel_x = -data.ball_vel_x;
-            hit_blink(0);
-            if (score >= 0 && game_settings->left == PLAYER) score++;
-            if (LOG_GAME) print_log(LOG_HEAD_GAME, "left paddle hit");
-        }
-    } else if (data.ball_pos_x > right_limit && previous_x <= right_limit) {
-        double ball_dir = data.ball_vel_y / data.ball_vel_x;
-        int hit_y = (double)previous_y + (double)(previous_x - right_limit) * ball_dir + 0.5;
-        if ((data.paddle_right_pos > hit_y - PADDLE_HEIGHT) && (data.paddle_right_pos < hit_y + BALL_SIZE)) {
-            on_hit_change_ball_vel_y(data.paddle_right_pos, hit_y, data.ball_pos_x - right_limit);
-            data.ball_pos_x = 2 * right_limit - data.ball_pos_x;
-            data.ball_vel_x = -data.ball_vel_x;
-            hit_blink(1);
-            if (score >= 0 && game_settings->right == PLAYER) score++;
-            if (LOG_GAME) print_log(LOG_HEAD_GAME, "right paddle hit");
-        }
+void update_balls(game_ctx_t* ctx) {
+    const fixed_t left_face = INT_TO_FIXED(PADDLE_WIDTH);
+    const fixed_t right_face = INT_TO_FIXED(LCD_WIDTH - PADDLE_WIDTH - BALL_SIZE);
+    const fixed_t top = INT_TO_FIXED(LIVES_FONT_SIZE);
+    const fixed_t bottom = INT_TO_FIXED(LCD_HEIGHT - BALL_SIZE);
+    struct balls* balls = &ctx->balls;
+    fixed_t* pos_x = balls->pos_x;
+    fixed_t* pos_y = balls->pos_y;
+    fixed_t* vel_x = balls->vel_x;
+    fixed_t* vel_y = balls->vel_y;
+    int count = balls->count;
+    char between[MAX_BALLS];
+    for (int i = 0; i < count; i++) {
+        fixed_t x = pos_x[i] + vel_x[i];
+        between[i] = pos_x[i] >= left_face && pos_x[i] <= right_face && x >= left_face && x <= right_face;
     }
-}
-
-/**
- * Change the y velocity of the ball acording to with which part of the paddle it has been hit. \n
- * Also recalculate last update in ball y coordinate.
- * @param paddle_y the y coordinate of the paddle when the hit occured
- * @param ball_y the y coordinate of the ball when the hit occured
- * @param overshoot how much did the last update (which possibly went through the paddle) overshoot the point where the ball was supposed to change direction
- */
-void on_hit_change_ball_vel_y(int paddle_y, int ball_y, int overshoot) {
-    double paddle_half_span = (double)(PADDLE_HEIGHT + BALL_SIZE - 1) / 2;
-    double ball_middle_y = (double)ball_y + (double)BALL_SIZE / 2 - 0.5;
-    double paddle_middle_y = (double)paddle_y + (double)PADDLE_HEIGHT / 2 - 0.5;
-    double relative_hit_y = ball_middle_y - paddle_middle_y;
-    double ball_dir = BOUNCE_CONST * relative_hit_y / paddle_half_span;
-    data.ball_vel_y = ball_dir * ball_speed + 0.5;
-    data.ball_pos_y = ball_y + (int)((double)overshoot * ball_dir + 0.5);
-}
-
-/**
- * Check ball collisions with the left and right edges of the game court. \n
- * Return non-zero value on collision.
- * @return -1 on left edge collision \n
- *          1 on right edge collision \n
- *          0 on no collision
- */
-char check_ball_left_right_edge_collision(void) {
-    if (data.ball_pos_x < 0) {
-        data.ball_pos_x = 0;
-        if (LOG_GAME) print_log(LOG_HEAD_GAME, "left player lost");
-        return -1;
+    // one wall bounce per update is enough, the y velocity is always much smaller than the height of the court
+    for (int i = 0; i < count; i++) {
+        if (!between[i]) continue;
+        fixed_t y = pos_y[i] + vel_y[i];
+        pos_x[i] += vel_x[i];
+        if (y < top) {
+            y = 2 * top - y;
+            vel_y[i] = -vel_y[i];
+        } else if (y > bottom) {
+            y = 2 * bottom - y;
+            vel_y[i] = -vel_y[i];
+        }
+        pos_y[i] = y;
     }
-    if (data.ball_pos_x > LCD_WIDTH - BALL_SIZE) {
-        data.ball_pos_x = LCD_WIDTH - BALL_SIZE;
-        if (LOG_GAME) print_log(LOG_HEAD_GAME, "right player lost");
-        return 1;
+    int paddle_y[2] = {ctx->data.paddle_left_pos, ctx->data.paddle_right_pos};
+    struct contact contacts[MAX_CONTACTS];
+    for (int i = 0; i < count && ctx->running; i++) {
+        if (between[i]) continue;
+        int contact_count = sweep_ball(&pos_x[i], &pos_y[i], &vel_x[i], &vel_y[i], paddle_y, ctx->ball_speed, contacts);
+        char side = 0;
+        for (int c = 0; c < contact_count; c++) side = on_ball_contact(ctx, &contacts[c]);
+        on_ball_left_right_edge_collision(ctx, side, i);
     }
-    return 0;
 }
 
 /**
  * Update lives accordingly, reset the ball or end the game depending on remaining lives.
+ * @param ctx the context of the game
  * @param side -1 for collision with left edge \n
  *              1 for collision with right edge \n
  *              function does nothing if 0
+ * @param ball the index of the lost ball in the multi-ball mode, not used in a game of one ball
  */
-void on_ball_left_right_edge_collision(char side) {
+void on_ball_left_right_edge_collision(game_ctx_t* ctx, char side, int ball) {
     if (side) {
-        ball_loss_blink(side == (char)-1 ? 0 : 1);
-        if (data.lives_left >= 0) {
-            char lives_ret = update_lives(side);
+        ball_loss_blink(ctx, side == (char)-1 ? 0 : 1);
+        count_ball_loss(ctx, side == (char)-1 ? 0 : 1);
+        if (ctx->data.lives_left >= 0) {
+            char lives_ret = update_lives(ctx, side);
             if (lives_ret) {
-                game_running = 0;
+                ctx->running = 0;
+                ctx->stats.winner = lives_ret == -1 ? 1 : 0;
                 if (lives_ret == -1) {
-                    if (LOG_GAME) print_log(LOG_HEAD_GAME, "left player lost");
+                    game_log(ctx, "left player lost");
                 } else if (lives_ret == 1) {
-                    if (LOG_GAME) print_log(LOG_HEAD_GAME, "right player lost");
+                    game_log(ctx, "right player lost");
                 }
+            } else if (ctx->balls.count) {
+                reset_multi_ball(ctx, ball);
             } else {
-                reset_ball();
+                reset_ball(ctx);
+                game_log(ctx, "ball reset");
             }
         } else {
-            if ((side == (char)-1 && game_settings->left == PLAYER) || (side == (char)1 && game_settings->right == PLAYER)) {
-                game_running = 0;
-                char str[21];
-                sprintf(str, "player lost: score %d", score);
-                if (LOG_GAME) print_log(LOG_HEAD_GAME, str);
+            if ((side == (char)-1 && ctx->settings->left == PLAYER) || (side == (char)1 && ctx->settings->right == PLAYER)) {
+                ctx->running = 0;
+                ctx->stats.winner = side == (char)-1 ? 1 : 0;
+                if (ctx->logging) {
+                    char str[32];
+                    sprintf(str, "player lost: score %d", ctx->score);
+                    print_log(LOG_HEAD_GAME, str);
+                }
             } else {
-                score += BONUS_ON_AI_BALL_LOSS;
-                reset_ball();
+                ctx->score += BONUS_ON_AI_BALL_LOSS;
+                reset_ball(ctx);
+                game_log(ctx, "ball reset");
             }
         }
     }
 }
 
 /**
- * Update the player lives.
+ * Update the player lives. Lives are counted only in games of two players or two bots.
+ * @param ctx the context of the game
  * @param looser -1 if the left player lost, \n
  *                1 if the right player lost
  * @return -1 if the left player has lost all of his/her lives, \n
  *          1 if the right player has lost all of his/her lives \n
  *          0 otherwise
  */
-char update_lives(char looser) {
+char update_lives(game_ctx_t* ctx, char looser) {
     if (looser == (char)-1) {
-        if (game_settings->left == PLAYER) {
-            data.lives_left--;
-            if (data.lives_left <= 0) return -1;
-        }
+        ctx->data.lives_left--;
+        if (ctx->data.lives_left <= 0) return -1;
     }
     if (looser == (char)1) {
-        if (game_settings->right == PLAYER) {
-            data.lives_right--;
-            if (data.lives_right <= 0) return 1;
-        }
+        ctx->data.lives_right--;
+        if (ctx->data.lives_right <= 0) return 1;
     }
     return 0;
 }
 
 /**
  * Reset the ball to the center of the game court and set its velocity randomly.
+ * @param ctx the context of the game
  */
-void reset_ball(void) {
-    data.ball_pos_x = (LCD_WIDTH - BALL_SIZE) / 2;
-    data.ball_pos_y = LIVES_FONT_SIZE + (LCD_HEIGHT - LIVES_FONT_SIZE - BALL_SIZE) / 2;
-    if (rand() % 2 == 0) {
-        data.ball_vel_y = -ball_speed;
-    } else {
-        data.ball_vel_y = ball_speed;
-    }
-    if (rand() % 2 == 0) {
-        data.ball_vel_x = -ball_speed;
+void reset_ball(game_ctx_t* ctx) {
+    ctx->data.ball_pos_x = INT_TO_FIXED((LCD_WIDTH - BALL_SIZE) / 2);
+    ctx->data.ball_pos_y = INT_TO_FIXED(LIVES_FONT_SIZE + (LCD_HEIGHT - LIVES_FONT_SIZE - BALL_SIZE) / 2);
+    if (rand_r(&ctx->seed) % 2 == 0) {
+        ctx->data.ball_vel_y = -INT_TO_FIXED(ctx->ball_speed);
     } else {
-        data.ball_vel_x = ball_speed;
+        ctx->data.ball_vel_y = INT_TO_FIXED(ctx->ball_speed);
     }
-    static char first = 1;
-    if (first) {
-        first = 0;
+    if (rand_r(&ctx->seed) % 2 == 0) {
+        ctx->data.ball_vel_x = -INT_TO_FIXED(ctx->ball_speed);
     } else {
-        if (LOG_GAME) print_log(LOG_HEAD_GAME, "ball reset");
+        ctx->data.ball_vel_x = INT_TO_FIXED(ctx->ball_speed);
     }
 }
 
+/**
+ * Put a ball of the multi-ball mode to the middle of the game court at a random height and set its velocity randomly.
+ * @param ctx the context of the game
+ * @param ball the index of the ball
+ */
+void reset_multi_ball(game_ctx_t* ctx, int ball) {
+    struct balls* balls = &ctx->balls;
+    balls->pos_x[ball] = INT_TO_FIXED((LCD_WIDTH - BALL_SIZE) / 2);
+    balls->pos_y[ball] = INT_TO_FIXED(LIVES_FONT_SIZE + rand_r(&ctx->seed) % (LCD_HEIGHT - LIVES_FONT_SIZE - BALL_SIZE + 1));
+    balls->vel_y[ball] = rand_r(&ctx->seed) % 2 ? INT_TO_FIXED(ctx->ball_speed) : -INT_TO_FIXED(ctx->ball_speed);
+    balls->vel_x[ball] = rand_r(&ctx->seed) % 2 ? INT_TO_FIXED(ctx->ball_speed) : -INT_TO_FIXED(ctx->ball_speed);
+}
+
 /**
  * Move the dot on the led line each call.
+ * @param ctx the context of the game
  */
-void move_led_line(void) {
-    static char dir = 0;
-    static uint32_t value = 1;
-    if (dir == 0 && value == 0b10000000000000000000000000000000) {
-        dir = 1;
-    } else if (value == 1) {
-        dir = 0;
+void move_led_line(game_ctx_t* ctx) {
+    if (ctx->led_line_dir == 0 && ctx->led_line == 0b10000000000000000000000000000000) {
+        ctx->led_line_dir = 1;
+    } else if (ctx->led_line == 1) {
+        ctx->led_line_dir = 0;
     }
-    if (dir == 0) {
-        value *= 2;
+    if (ctx->led_line_dir == 0) {
+        ctx->led_line *= 2;
     } else {
-        value /= 2;
+        ctx->led_line /= 2;
     }
-    *(volatile uint32_t*)(memory + SPILED_REG_LED_LINE_o) = value;
+    if (ctx->membase) *(volatile uint32_t*)(ctx->membase + SPILED_REG_LED_LINE_o) = ctx->led_line;
 }
 
 /**
- * Called upon ball-paddle collision. Start on-hit diode blink, set countdown.
+ * Light the rgb diode on the given side, does nothing in a game without leds.
+ * @param ctx the context of the game
  * @param is_right 0 for left diode, 1 for right diode
+ * @param color the color of the diode
  */
-void hit_blink(char is_right) {
+void light_diode(game_ctx_t* ctx, char is_right, uint32_t color) {
+    if (!ctx->membase) return;
     if (is_right) {
-        if (!ball_loss_blink_right_countdown) {
-            light_right_diode(memory, HIT_BLINK_COLOR);
-            hit_blink_right_countdown = (double)(HIT_BLINK_DURATION * UPDATES_PER_SECOND) / (double)1000 + 0.5;
-        }
+        light_right_diode(ctx->membase, color);
     } else {
-        if (!ball_loss_blink_left_countdown) {
-            light_left_diode(memory, HIT_BLINK_COLOR);
-            hit_blink_left_countdown = (double)(HIT_BLINK_DURATION * UPDATES_PER_SECOND) / (double)1000 + 0.5;
-        }
+        light_left_diode(ctx->membase, color);
     }
 }
 
 /**
- * Called upon loss of the ball. Start on-ball-loss diode blink, set countdown.
+ * Count a hit of the ball by the paddle in the statistics of the game.
+ * @param ctx the context of the game
+ * @param is_right 0 for the left paddle, 1 for the right paddle
+ */
+void count_hit(game_ctx_t* ctx, char is_right) {
+    ctx->stats.hits[(int)is_right]++;
+    ctx->stats.rally_hits++;
+    if (ctx->stats.rally_hits > ctx->stats.longest_rally) ctx->stats.longest_rally = ctx->stats.rally_hits;
+}
+
+/**
+ * Count a lost ball in the statistics of the game, which also ends the current rally.
+ * @param ctx the context of the game
+ * @param is_right 0 if the left side lost the ball, 1 if the right side lost it
+ */
+void count_ball_loss(game_ctx_t* ctx, char is_right) {
+    ctx->stats.balls_lost[(int)is_right]++;
+    ctx->stats.rallies++;
+    ctx->stats.rally_hits = 0;
+}
+
+/**
+ * Called upon ball-paddle collision. Start on-hit diode blink, set countdown.
+ * @param ctx the context of the game
  * @param is_right 0 for left diode, 1 for right diode
  */
-void ball_loss_blink(char is_right) {
-    if (is_right) {
-        light_right_diode(memory, BALL_LOSS_BLINK_COLOR);
-        ball_loss_blink_right_countdown = (double)(BALL_LOSS_BLINK_DURATION * UPDATES_PER_SECOND) / (double)1000 + 0.5;
-        hit_blink_right_countdown = 0;
-    } else {
-        light_left_diode(memory, BALL_LOSS_BLINK_COLOR);
-        ball_loss_blink_left_countdown = (double)(BALL_LOSS_BLINK_DURATION * UPDATES_PER_SECOND) / (double)1000 + 0.5;
-        hit_blink_left_countdown = 0;
+void hit_blink(game_ctx_t* ctx, char is_right) {
+    if (!ctx->ball_loss_blink_countdown[(int)is_right]) {
+        light_diode(ctx, is_right, HIT_BLINK_COLOR);
+        ctx->hit_blink_countdown[(int)is_right] = (double)(HIT_BLINK_DURATION * UPDATES_PER_SECOND) / (double)1000 + 0.5;
     }
 }
 
+/**
+ * Called upon loss of the ball. Start on-ball-loss diode blink, set countdown.
+ * @param ctx the context of the game
+ * @param is_right 0 for left diode, 1 for right diode
+ */
+void ball_loss_blink(game_ctx_t* ctx, char is_right) {
+    light_diode(ctx, is_right, BALL_LOSS_BLINK_COLOR);
+    ctx->ball_loss_blink_countdown[(int)is_right] = (double)(BALL_LOSS_BLINK_DURATION * UPDATES_PER_SECOND) / (double)1000 + 0.5;
+    ctx->hit_blink_countdown[(int)is_right] = 0;
+}
+
 /**
  * Called every game update. Counts down and ends the diode blink.
+ * @param ctx the context of the game
  */
-void update_diodes(void) {
-    static int ball_loss_blink_period = (double)(BALL_LOSS_BLINK_PERIOD * UPDATES_PER_SECOND) / (double)1000 + 0.5;
-    // right diode
-    if (ball_loss_blink_right_countdown) {
-        ball_loss_blink_right_countdown--;
-        if (!ball_loss_blink_right_countdown) {
-            light_right_diode(memory, NORMAL_LED_COLOR);
-        } else if (ball_loss_blink_right_countdown % ball_loss_blink_period == 0) {
-            if (ball_loss_blink_right_countdown / ball_loss_blink_period % 2 == 0) {
-                light_right_diode(memory, LED_OFF_COLOR);
-            } else {
-                light_right_diode(memory, BALL_LOSS_BLINK_COLOR);
+void update_diodes(game_ctx_t* ctx) {
+    const int ball_loss_blink_period = (double)(BALL_LOSS_BLINK_PERIOD * UPDATES_PER_SECOND) / (double)1000 + 0.5;
+    for (int side = 1; side >= 0; side--) {
+        int* ball_loss_countdown = &ctx->ball_loss_blink_countdown[side];
+        int* hit_countdown = &ctx->hit_blink_countdown[side];
+        if (*ball_loss_countdown) {
+            (*ball_loss_countdown)--;
+            if (!*ball_loss_countdown) {
+                light_diode(ctx, side, NORMAL_LED_COLOR);
+            } else if (*ball_loss_countdown % ball_loss_blink_period == 0) {
+                if (*ball_loss_countdown / ball_loss_blink_period % 2 == 0) {
+                    light_diode(ctx, side, LED_OFF_COLOR);
+                } else {
+                    light_diode(ctx, side, BALL_LOSS_BLINK_COLOR);
+                }
             }
-        }
-    } else if (hit_blink_right_countdown) {
-        hit_blink_right_countdown--;
-        if (!hit_blink_right_countdown) {
-            light_right_diode(memory, NORMAL_LED_COLOR);
-        }
-    }
-    // left didode
-    if (ball_loss_blink_left_countdown) {
-        ball_loss_blink_left_countdown--;
-        if (!ball_loss_blink_left_countdown) {
-            light_left_diode(memory, NORMAL_LED_COLOR);
-        } else if (ball_loss_blink_left_countdown % ball_loss_blink_period == 0) {
-            if (ball_loss_blink_left_countdown / ball_loss_blink_period % 2 == 0) {
-                light_left_diode(memory, LED_OFF_COLOR);
-            } else {
-                light_left_diode(memory, BALL_LOSS_BLINK_COLOR);
+        } else if (*hit_countdown) {
+            (*hit_countdown)--;
+            if (!*hit_countdown) {
+                light_diode(ctx, side, NORMAL_LED_COLOR);
             }
         }
-    } else if (hit_blink_left_countdown) {
-        hit_blink_left_countdown--;
-        if (!hit_blink_left_countdown) {
-            light_left_diode(memory, NORMAL_LED_COLOR);
-        }
     }
 }
 
+/**
+ * Print the message to the log if logging is enabled for the game.
+ * @param ctx the context of the game
+ * @param msg the message
+ */
+void game_log(game_ctx_t* ctx, char* msg) {
+    if (ctx->logging) print_log(LOG_HEAD_GAME, msg);
+}
+
 /**
  * REPLACED WITH POST-GAME SCREEN IMPLEMENTATION IN GRAPHICS.H
  * 
  * The post game screen logic.
+ * @param ctx the context of the game
  */
-void post_game_screen(void) {
-    if (score >= 0) {
-        view_score_screen(score);
+void post_game_screen(game_ctx_t* ctx) {
+    if (ctx->score >= 0) {
+        view_score_screen(ctx->score);
     } else {
-        view_victory_screen(data.lives_left ? 0 : 1);
+        view_victory_screen(ctx->data.lives_left ? 0 : 1);
     }
     while (getchar() != ENTER);
 }
+
+/**
+ * Copy the balls in use from one set of balls to another.
+ * @param dst the balls to be overwritten
+ * @param src the balls to be copied
+ */
+void copy_balls(struct balls* dst, struct balls* src) {
+    size_t size = src->count * sizeof(fixed_t);
+    dst->count = src->count;
+    memcpy(dst->pos_x, src->pos_x, size);
+    memcpy(dst->pos_y, src->pos_y, size);
+    memcpy(dst->vel_x, src->vel_x, size);
+    memcpy(dst->vel_y, src->vel_y, size);
+}
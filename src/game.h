@@ -6,6 +6,8 @@
 
 #include "settings.h"
 #include "peripherals.h"
+#include "fixed.h"
+#include <stdint.h>
 
 #define LIVES_FONT_SIZE (44)
 #define BALL_SIZE (20)
@@ -14,10 +16,15 @@
 #define INITIAL_LIVES (3)
 #define BOUNCE_CONST (2)
 #define BONUS_ON_AI_BALL_LOSS (3)
+// the multi-ball mode (MULTI_BALL_COUNT balls), every lost ball costs a life and comes back to the middle of the court
+#define MAX_BALLS (48)
+#define MULTI_BALL_LIVES (20)
 
 // ball speed is fixed for the x axis, and varies from this initial value slightly on the y axis to change the angle of travel
 // updates per second directly affect speeds of objects as the speeds are equal to the number of pixels per update
 #define UPDATES_PER_SECOND (50)
+// the maximum number of updates run back-to-back when the game loop wakes up late, the rest is dropped
+#define MAX_CATCH_UP_UPDATES (3)
 #define PADDLE_SPEED_KEY (3)
 #define PADDLE_SPEED_KNOB (3)
 #define BALL_SPEED_MEDIUM (5)
@@ -40,17 +47,106 @@
  * The coordinates of an object are the coordinates of its top left corner. \n
  * The y coordinate is always within < LIVES_FONT_SIZE ; LCD_HEIGHT - [height of the object] > \n
  * The x coordinate is always within < 0 ; LCD_WIDTH - [width of the object] > \n
+ * The position and velocity of the ball are fixed-point numbers (pixels and pixels per update),
+ * the paddles move by whole pixels.
  * @see graphics.h for LCD_HEIGHT, LCD_WIDTH
+ * @see fixed.h for fixed_t
  */
 struct game_data {
-    int ball_pos_x, ball_pos_y;
-    int ball_vel_x, ball_vel_y;
+    fixed_t ball_pos_x, ball_pos_y;
+    fixed_t ball_vel_x, ball_vel_y;
     int paddle_left_pos;
     int paddle_right_pos;
     int lives_left;
     int lives_right;
 };
 
+/**
+ * The balls of the multi-ball mode stored as parallel arrays, so the updates of all balls run as tight loops. \n
+ * Ball i is at (pos_x[i], pos_y[i]) and moves by (vel_x[i], vel_y[i]), the same fixed-point units as in struct game_data.
+ */
+struct balls {
+    int count;
+    fixed_t pos_x[MAX_BALLS];
+    fixed_t pos_y[MAX_BALLS];
+    fixed_t vel_x[MAX_BALLS];
+    fixed_t vel_y[MAX_BALLS];
+};
+
+/**
+ * Input of both players for one game update.
+ */
+struct tick_input {
+    /** -1 if the key for "UP" has been pressed since the last update, 1 for "DOWN", 0 for no key */
+    char key_dir[2];
+    /** movement of the knobs since the last update, <0 for counter-clockwise, >0 for clockwise */
+    int knob_diff[2];
+};
+
+// the size of the state of the AI of one paddle in 32-bit words
+#define AI_STATE_WORDS (64)
+
+/**
+ * State the AI keeps between updates, one for each paddle. \n
+ * Every AI keeps its own structure in it (see ai_interface.h), so the state is copied, saved and restored
+ * together with the rest of the game context.
+ */
+struct ai_state {
+    int32_t words[AI_STATE_WORDS];
+};
+
+/**
+ * Statistics of one game, index 0 of the arrays is the left side, index 1 the right side.
+ */
+struct game_stats {
+    /** updates run so far */
+    long ticks;
+    /** balls hit by the paddle */
+    int hits[2];
+    /** balls lost */
+    int balls_lost[2];
+    /** finished rallies, i.e. balls lost by any side */
+    int rallies;
+    /** paddle hits in the current rally and the most hits in one rally */
+    int rally_hits, longest_rally;
+    /** 0 if the left side won, 1 if the right side won, -1 while nobody has won */
+    int winner;
+};
+
+/**
+ * Everything one game needs between updates. \n
+ * Index 0 of the arrays is the left side, index 1 the right side. \n
+ * Games with their own contexts are independent and can run on different threads at once.
+ */
+typedef struct game_ctx {
+    struct game_data data;
+    /** the balls of the multi-ball mode, count is 0 in a game of the single ball in data */
+    struct balls balls;
+    /** the ball each AI follows in the multi-ball mode */
+    int focus_ball[2];
+    int ball_speed;
+    int score;
+    char running;
+    /** print the events of the game to the log */
+    char logging;
+    settings_t* settings;
+    /** the AI of each paddle that is not controlled by a player, initialized from the settings */
+    int ai[2];
+    /** the base of the memory of the system, NULL if there are no leds */
+    unsigned char* membase;
+    /** state of the random numbers used by the ball resets and the AI */
+    unsigned int seed;
+    /** the seed the game was initialized with, a replay of the game starts from it */
+    unsigned int initial_seed;
+    char last_key[2];
+    int hit_blink_countdown[2];
+    int ball_loss_blink_countdown[2];
+    uint32_t led_line;
+    char led_line_dir;
+    struct ai_state ai_state[2];
+    struct game_stats stats;
+} game_ctx_t;
+
 /**
  * Call this function to initialize the game.
  * @param membase the base of the memory of the system
@@ -61,4 +157,49 @@ struct game_data {
  */
 int start_game(unsigned char* membase, unsigned char* lcd_membase, knobs_t* knobs, settings_t* settings);
 
+/**
+ * Record the input of every following game into a replay file. \n
+ * Game number n is recorded into the file "path.n".
+ * @param path the beginning of the names of the replay files, NULL to stop recording
+ */
+void record_games(char* path);
+
+/**
+ * Initialize a game context.
+ * @param ctx the context to be initialized
+ * @param settings contains the settings from the menu, it is only read and must outlive the context
+ * @param membase the base of the memory of the system, NULL for a game without leds
+ * @param seed the seed of the random numbers of this game
+ */
+void init_game_ctx(game_ctx_t* ctx, settings_t* settings, unsigned char* membase, unsigned int seed);
+
+/**
+ * Release everything the AIs of the paddles acquired, the context can be initialized again afterwards.
+ * @param ctx the context of the game
+ */
+void destroy_game_ctx(game_ctx_t* ctx);
+
+/**
+ * Replace the AI of a paddle, the new AI starts with a fresh state.
+ * @param ctx the context of the game
+ * @param is_right 0 for the left paddle, 1 for the right one
+ * @param ai the id of the AI in the registry of ai_registry.h
+ */
+void set_game_ai(game_ctx_t* ctx, char is_right, int ai);
+
+/**
+ * Run one update of the game: move the paddles according to the input or the AI, move the ball and check for collisions.
+ * @param ctx the context of the game
+ * @param input the input of the players for this update
+ * @return 1 if the game continues, 0 if it has ended
+ */
+char update(game_ctx_t* ctx, struct tick_input input);
+
+/**
+ * Copy the balls in use from one set of balls to another.
+ * @param dst the balls to be overwritten
+ * @param src the balls to be copied
+ */
+void copy_balls(struct balls* dst, struct balls* src);
+
 #endif
@@ -8,18 +8,33 @@
 #include "graphics.h"
 #include "log.h"
 #include "game.h"
+#include "tick_scheduler.h"
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
+#include <string.h>
 
-void clear_buffer(void);
+/**
+ * Values displayed in the bar at the top of the screen.
+ */
+struct hud_values {
+    int lives_left, lives_right;
+    // the score, or the game time in seconds in PvP mode
+    int value;
+};
+
+void create_background(void);
+void clear_background(void);
 void add_lives_background(void);
 void add_middle_line(void);
-void add_lives(void);
-void add_time(void);
-void add_score(int score);
+void restore_background(rect_t rect);
+void update_hud(int score);
+int get_game_seconds(void);
+void build_hud_strip(struct hud_values values, char is_time);
+void show_hud_rect(rect_t rect);
 void add_paddles(void);
-void add_ball(void);
+void add_balls(void);
+rect_t ball_rect(struct balls* balls, int ball);
 void render(void);
 void add_post_game_screen_reminder(void);
 void easter_egg(void);
@@ -27,14 +42,24 @@ uint16_t random_color(void);
 
 static unsigned char* lcd_mem;
 static uint16_t display_buff[LCD_HEIGHT * LCD_WIDTH];
+static uint16_t background[LCD_HEIGHT * LCD_WIDTH];
 static struct game_data data;
+static struct game_data last_data;
+// the balls of the frame, a game of one ball has its ball here too
+static struct balls view_balls;
+static struct balls last_balls;
+static damage_t damage;
+static uint16_t hud_strip[LCD_WIDTH * LIVES_FONT_SIZE];
+static struct hud_values hud_values;
+static char hud_valid;
+static rect_t hud_text_rect;
 static uint16_t ball_color, left_paddle_color, right_paddle_color;
-static clock_t game_time = 0;
-static clock_t last_update = 0;
+static long long game_time = 0;
+static long long last_update = 0;
 
 
 /**
- * Save the given pointer to the lcd display memory.
+ * Save the given pointer to the lcd display memory and prepare the game court.
  * @param lcd_membase the base of the memory of the lcd display to render to
  * @param settings the settings given from the menu
  */
@@ -43,33 +68,61 @@ void init_view(unsigned char* lcd_membase, settings_t* settings) {
     ball_color = settings->ballcolor;
     left_paddle_color = settings->paddlecolors[0];
     right_paddle_color = settings->paddlecolors[1];
-    last_update = clock();
+    game_time = 0;
+    last_update = monotonic_ns();
+    create_background();
+    /* the first frame starts from the empty court and has to be rendered whole */
+    memcpy(display_buff, background, sizeof(display_buff));
+    add_full_damage(&damage);
+    last_balls.count = 0;
+    hud_text_rect = (rect_t){0, 0, 0, 0};
+    hud_valid = 0;
     if (LOG_GAME_VIEW) print_log(LOG_HEAD_GAME_VIEW, "initialized");
 }
 
 /**
- * Store the given game data and use it to render all game components.
+ * Store the given game data and use it to render all game components. \n
+ * The display buffer keeps the previous frame, only the places the paddles and the balls left
+ * are repaired from the background before the game objects are drawn at their new positions.
  * @param game_data contains information about the state of the game
+ * @param balls the balls of the multi-ball mode, NULL for the single ball in game_data
  * @param score the current score of the player; is set to -1 in PvP mode
  */
-void update_view(struct game_data game_data, int score) {
+void update_view(struct game_data game_data, struct balls* balls, int score) {
     data = game_data;
-    clear_buffer();
-    add_lives_background();
-    add_middle_line();
-    if (data.lives_left >= 0) add_lives();
-    score >= 0 ? add_score(score) : add_time();
+    if (balls) {
+        copy_balls(&view_balls, balls);
+    } else {
+        view_balls.count = 1;
+        view_balls.pos_x[0] = data.ball_pos_x;
+        view_balls.pos_y[0] = data.ball_pos_y;
+    }
+    restore_background((rect_t){0, last_data.paddle_left_pos, PADDLE_WIDTH, PADDLE_HEIGHT});
+    restore_background((rect_t){LCD_WIDTH - PADDLE_WIDTH, last_data.paddle_right_pos, PADDLE_WIDTH, PADDLE_HEIGHT});
+    for (int i = 0; i < last_balls.count; i++) restore_background(ball_rect(&last_balls, i));
+    update_hud(score);
     add_paddles();
-    add_ball();
+    add_balls();
     render();
+    last_data = data;
+    copy_balls(&last_balls, &view_balls);
 }
 
 /**
- * Fill the display buffer with blackness.
+ * Create the layer with the parts of the game court which do not change during the game.
  */
-void clear_buffer(void) {
+void create_background(void) {
+    clear_background();
+    add_lives_background();
+    add_middle_line();
+}
+
+/**
+ * Fill the background with blackness.
+ */
+void clear_background(void) {
     int window_size = LCD_HEIGHT * LCD_WIDTH;
-    for (int i = 0; i < window_size; i++) display_buff[i] = BACKGROUND_COLOR;
+    for (int i = 0; i < window_size; i++) background[i] = BACKGROUND_COLOR;
 }
 
 /**
@@ -78,7 +131,7 @@ void clear_buffer(void) {
 void add_lives_background(void) {
     for (int y = 0; y < LIVES_FONT_SIZE; y++) {
         for (int x = 0; x < LCD_WIDTH; x++) {
-            display_buff[y * LCD_WIDTH + x] = LIVES_BACKGROUND_COLOR;
+            background[y * LCD_WIDTH + x] = LIVES_BACKGROUND_COLOR;
         }
     }
 }
@@ -91,62 +144,105 @@ void add_middle_line(void) {
     for (int y = LIVES_FONT_SIZE; y < LCD_HEIGHT; y++) {
         if (y / MIDDLE_LINE_LENGTH % 2 == 0) {
             for (int x = 0; x < MIDDLE_LINE_WIDTH; x++) {
-                display_buff[y * LCD_WIDTH + center_x + x] = MIDDLE_LINE_COLOR;
+                background[y * LCD_WIDTH + center_x + x] = MIDDLE_LINE_COLOR;
             }
         }
     }
 }
 
 /**
- * Render player lives into the display buffer using the stored data.
+ * Copy the given area of the background into the display buffer.
+ * @param rect the area to be repaired, it has to lie within the display
  */
-void add_lives(void) {
-    char number[2];
-    sprintf(number, "%d", data.lives_left);
-    put_string(0, 0, display_buff, &font_wArial_44, number, (uint16_t)LIVES_COLOR, (uint16_t)LIVES_BACKGROUND_COLOR);
-    sprintf(number, "%d", data.lives_right);
-    put_string(LCD_WIDTH - get_char_width(&font_wArial_44, number[0]), 0, display_buff, &font_wArial_44, number, (uint16_t)LIVES_COLOR, (uint16_t)LIVES_BACKGROUND_COLOR);
+void restore_background(rect_t rect) {
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        memcpy(display_buff + y * LCD_WIDTH + rect.x, background + y * LCD_WIDTH + rect.x, rect.width * sizeof(uint16_t));
+    }
 }
 
 /**
- * Render game time.
+ * Update the bar at the top of the screen with lives and score or game time. \n
+ * The bar is kept in its own strip which is rebuilt only when the displayed values change,
+ * on other frames the bar is neither drawn nor sent to the display.
+ * @param score the current score of the player; is set to -1 in PvP mode
  */
-void add_time(void) {
-    clock_t now = clock();
+void update_hud(int score) {
+    struct hud_values values = {data.lives_left, data.lives_right, score};
+    if (score == -1) {
+        values.value = get_game_seconds();
+    } else if (score > MAX_SCORE) {
+        easter_egg();
+    }
+    if (hud_valid && values.lives_left == hud_values.lives_left && values.lives_right == hud_values.lives_right && values.value == hud_values.value) return;
+    build_hud_strip(values, score == -1);
+    hud_values = values;
+    hud_valid = 1;
+}
+
+/**
+ * Count the game time.
+ * @return the number of whole seconds since the start of the game
+ */
+int get_game_seconds(void) {
+    long long now = monotonic_ns();
     game_time += now - last_update;
     last_update = now;
-    if (game_time < 0 || game_time > MAX_TIME) {
-        easter_egg();
-    } else {
-        char time[6];
-        int seconds = game_time / CLOCKS_PER_SEC;
-        int minutes = seconds / 60;
-        seconds = seconds % 60;
-        sprintf(time, "%d:%d", minutes, seconds);
-        put_string((LCD_WIDTH - get_string_width(&font_wArial_44, time)) / 2, 0, display_buff, &font_wArial_44, time, (uint16_t)TIME_SCORE_COLOR, (uint16_t)LIVES_BACKGROUND_COLOR);
+    if (game_time < 0 || game_time / NSEC_PER_MSEC > MAX_TIME) easter_egg();
+    return game_time / NSEC_PER_SEC;
+}
+
+/**
+ * Draw the bar with the given values into the strip and copy the parts that changed into the display buffer.
+ * @param values the values to be displayed
+ * @param is_time 1 if the value is the game time in seconds, 0 if it is the score
+ */
+void build_hud_strip(struct hud_values values, char is_time) {
+    memcpy(hud_strip, background, sizeof(hud_strip));
+    if (values.lives_left >= 0) {
+        char number[12];
+        sprintf(number, "%d", values.lives_left);
+        put_string(0, 0, hud_strip, &font_wArial_44, number, (uint16_t)LIVES_COLOR, (uint16_t)LIVES_BACKGROUND_COLOR);
+        sprintf(number, "%d", values.lives_right);
+        put_string(LCD_WIDTH - get_char_width(&font_wArial_44, number[0]), 0, hud_strip, &font_wArial_44, number, (uint16_t)LIVES_COLOR, (uint16_t)LIVES_BACKGROUND_COLOR);
+        if (!hud_valid || values.lives_left != hud_values.lives_left || values.lives_right != hud_values.lives_right) {
+            show_hud_rect((rect_t){0, 0, font_wArial_44.maxwidth, LIVES_FONT_SIZE});
+            show_hud_rect((rect_t){LCD_WIDTH - font_wArial_44.maxwidth, 0, font_wArial_44.maxwidth, LIVES_FONT_SIZE});
+        }
+    }
+    char text[24] = "";
+    if (is_time) {
+        sprintf(text, "%d:%d", values.value / 60, values.value % 60);
+    } else if (values.value >= 0) {
+        sprintf(text, "%d", values.value);
     }
+    int width = get_string_width(&font_wArial_44, text);
+    rect_t text_rect = {(LCD_WIDTH - width) / 2, 0, width, LIVES_FONT_SIZE};
+    put_string(text_rect.x, 0, hud_strip, &font_wArial_44, text, (uint16_t)TIME_SCORE_COLOR, (uint16_t)LIVES_BACKGROUND_COLOR);
+    // the previous text has been replaced by the background in the strip
+    show_hud_rect(hud_text_rect);
+    show_hud_rect(text_rect);
+    hud_text_rect = text_rect;
 }
 
 /**
- * Render player score.
- * @param score the current score of the player
+ * Copy the given area of the bar strip into the display buffer and mark it as changed.
+ * @param rect the area of the bar, it has to lie within the bar
  */
-void add_score(int score) {
-    if (score < -1) {
-        return;
-    } else if (score > MAX_SCORE) {
-        easter_egg();
-    } else {
-        char score_text[6];
-        sprintf(score_text, "%d", score);
-        put_string((LCD_WIDTH - get_string_width(&font_wArial_44, score_text)) / 2, 0, display_buff, &font_wArial_44, score_text, (uint16_t)TIME_SCORE_COLOR, (uint16_t)LIVES_BACKGROUND_COLOR);
+void show_hud_rect(rect_t rect) {
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        memcpy(display_buff + y * LCD_WIDTH + rect.x, hud_strip + y * LCD_WIDTH + rect.x, rect.width * sizeof(uint16_t));
     }
+    add_damage(&damage, rect);
 }
 
 /**
  * Render the paddles into the display buffer using the stored data.
  */
 void add_paddles(void) {
+    add_damage(&damage, (rect_t){0, last_data.paddle_left_pos, PADDLE_WIDTH, PADDLE_HEIGHT});
+    add_damage(&damage, (rect_t){0, data.paddle_left_pos, PADDLE_WIDTH, PADDLE_HEIGHT});
+    add_damage(&damage, (rect_t){LCD_WIDTH - PADDLE_WIDTH, last_data.paddle_right_pos, PADDLE_WIDTH, PADDLE_HEIGHT});
+    add_damage(&damage, (rect_t){LCD_WIDTH - PADDLE_WIDTH, data.paddle_right_pos, PADDLE_WIDTH, PADDLE_HEIGHT});
     for (int y = data.paddle_left_pos; y < data.paddle_left_pos + PADDLE_HEIGHT; y++) {
         for (int x = 0; x < PADDLE_WIDTH; x++) {
             display_buff[y * LCD_WIDTH + x] = left_paddle_color;
@@ -160,23 +256,37 @@ void add_paddles(void) {
 }
 
 /**
- * Render the ball into the display buffer using the stored data.
+ * Render the balls into the display buffer using the stored data. \n
+ * The damage of neighbouring balls is merged, so many balls do not mean many separate writes to the display.
  */
-void add_ball(void) {
-    for (int y = 0; y < BALL_SIZE; y++) {
-        for (int x = 0; x < BALL_SIZE; x++) {
-            display_buff[(data.ball_pos_y + y) * LCD_WIDTH + (data.ball_pos_x + x)] = ball_color;
+void add_balls(void) {
+    for (int i = 0; i < last_balls.count; i++) add_damage(&damage, ball_rect(&last_balls, i));
+    for (int i = 0; i < view_balls.count; i++) {
+        rect_t ball = ball_rect(&view_balls, i);
+        add_damage(&damage, ball);
+        uint16_t* row = display_buff + ball.y * LCD_WIDTH + ball.x;
+        for (int y = 0; y < BALL_SIZE; y++, row += LCD_WIDTH) {
+            for (int x = 0; x < BALL_SIZE; x++) row[x] = ball_color;
         }
     }
 }
 
 /**
- * Copy the pixels from the display buffer to the actual display memory.
+ * Get the pixels covered by a ball, its fixed-point position is rounded to whole pixels.
+ * @param balls the balls of the frame
+ * @param ball the index of the ball
+ * @return the rectangle of the ball on the display
+ */
+rect_t ball_rect(struct balls* balls, int ball) {
+    return (rect_t){FIXED_ROUND(balls->pos_x[ball]), FIXED_ROUND(balls->pos_y[ball]), BALL_SIZE, BALL_SIZE};
+}
+
+/**
+ * Copy the pixels which changed since the last render from the display buffer to the actual display memory. \n
+ * Only the changed areas are sent to the display using its column and page address windows.
  */
 void render(void) {
-    parlcd_write_cmd(lcd_mem, LCD_WRITE);
-    int buffer_size = LCD_HEIGHT * LCD_WIDTH;
-    for (int i = 0; i < buffer_size; i++) parlcd_write_data(lcd_mem, display_buff[i]);
+    show_damage(display_buff, lcd_mem, &damage);
 }
 
 /**
@@ -191,6 +301,7 @@ void view_score_screen(int score) {
         add_post_game_screen_reminder();
         put_string((LCD_WIDTH - get_string_width(&font_wArial_88, score_text)) / 2, (LCD_HEIGHT - 88) / 2, display_buff, &font_wArial_88, score_text, POST_GAME_SCREEN_FOREGROUND, POST_GAME_SCREEN_BACKGROUND);
     }
+    add_full_damage(&damage);
     render();
 }
 
@@ -209,6 +320,7 @@ void view_victory_screen(char winner) {
         char str[] = "LEFT PLAYER WINS";
         put_string((LCD_WIDTH - get_string_width(&font_wArial_44, str)) / 2, (LCD_HEIGHT - 44) / 2, display_buff, &font_wArial_44, str, POST_GAME_SCREEN_FOREGROUND, POST_GAME_SCREEN_BACKGROUND);
     }
+    add_full_damage(&damage);
     render();
 }
 
@@ -234,6 +346,7 @@ void easter_egg(void) {
         color2 = random_color();
         for (int i = 0; i < window_size; i++) display_buff[i] = color1;
         put_string((LCD_WIDTH - get_string_width(&font_wArial_88, str)) / 2, (LCD_HEIGHT - 88) / 2, display_buff, &font_wArial_88, str, color2, color1);
+        add_full_damage(&damage);
         render();
         if (m == (uint8_t)0) {
             printf("poop");
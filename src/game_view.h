@@ -17,7 +17,8 @@
 #define MIDDLE_LINE_WIDTH (4)
 #define MIDDLE_LINE_LENGTH (12)
 #define MAX_SCORE (99999)
-#define MAX_TIME (2100000000)
+// in milliseconds
+#define MAX_TIME (2100000)
 
 #define LOG_HEAD_GAME_VIEW "GAME_VIEW: "
 #define LOG_GAME_VIEW 1
@@ -32,9 +33,10 @@ void init_view(unsigned char* lcd_membase, settings_t* settings);
 /**
  * Call to update the game view.
  * @param game_data an instance of struct game_data from the game.h file
+ * @param balls the balls of the multi-ball mode, NULL for the single ball in game_data
  * @param score the score the player achieved in the game
  */
-void update_view(struct game_data game_data, int score);
+void update_view(struct game_data game_data, struct balls* balls, int score);
 
 /**
  * REPLACED WITH POST-GAME SCREEN IMPLEMENTATION IN GRAPHICS.H
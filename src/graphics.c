@@ -52,10 +52,218 @@ void destroy_frame(uint16_t *frame) {
  * @param lcd_membase pointer to base address of lcd display to render on
  */
 void show_frame(uint16_t *frame, unsigned char *lcd_membase) {
+    set_lcd_window(lcd_membase, (rect_t){0, 0, LCD_WIDTH, LCD_HEIGHT});
     parlcd_write_cmd(lcd_membase, LCD_WRITE);
-    for (int i = 0; i < LCD_HEIGHT * LCD_WIDTH; i++) {
-        parlcd_write_data(lcd_membase, frame[i]);
+    stream_pixels(lcd_membase, frame, (rect_t){0, 0, LCD_WIDTH, LCD_HEIGHT});
+}
+
+/**
+ * sets area of the lcd display that is written by following LCD_WRITE command \n
+ * pixels are then consumed row by row from top-left corner of the area
+ *
+ * @param lcd_membase pointer to base address of lcd display
+ * @param rect area of the display that will be written
+ */
+void set_lcd_window(unsigned char *lcd_membase, rect_t rect) {
+    int x_end = rect.x + rect.width - 1;
+    int y_end = rect.y + rect.height - 1;
+    /* start and end addresses are sent as high and low byte */
+    parlcd_write_cmd(lcd_membase, LCD_COLUMN_ADDRESS_SET);
+    parlcd_write_data(lcd_membase, (rect.x >> 8) & 0xffu);
+    parlcd_write_data(lcd_membase, rect.x & 0xffu);
+    parlcd_write_data(lcd_membase, (x_end >> 8) & 0xffu);
+    parlcd_write_data(lcd_membase, x_end & 0xffu);
+    parlcd_write_cmd(lcd_membase, LCD_PAGE_ADDRESS_SET);
+    parlcd_write_data(lcd_membase, (rect.y >> 8) & 0xffu);
+    parlcd_write_data(lcd_membase, rect.y & 0xffu);
+    parlcd_write_data(lcd_membase, (y_end >> 8) & 0xffu);
+    parlcd_write_data(lcd_membase, y_end & 0xffu);
+}
+
+/**
+ * streams pixels of passed area of frame to the lcd data register \n
+ * two pixels are sent in every write, pairs continue over row ends so only
+ * an area with odd number of pixels needs one single pixel write at its end \n
+ * LCD_WRITE command has to be sent before and the window has to match the area
+ *
+ * @param lcd_membase pointer to base address of lcd display
+ * @param frame pointer to frame buffer with pixels to be sent
+ * @param rect area of frame to be sent
+ */
+void stream_pixels(unsigned char *lcd_membase, uint16_t *frame, rect_t rect) {
+    int rows = rect.height;
+    int width = rect.width;
+    /* rows spanning whole display follow each other in memory and are sent as one long row */
+    if (rect.x == 0 && rect.width == LCD_WIDTH) {
+        width *= rows;
+        rows = 1;
+    }
+    int has_pending = 0;
+    uint16_t pending = 0;
+    for (int row = 0; row < rows; row++) {
+        uint16_t *src = frame + (rect.y + row) * LCD_WIDTH + rect.x;
+        int count = width;
+        /* finish the pair started by the last pixel of previous row */
+        if (has_pending && count > 0) {
+            parlcd_write_data2x(lcd_membase, PACK_PIXELS(pending, src[0]));
+            src++;
+            count--;
+            has_pending = 0;
+        }
+        int pairs = count / 2;
+        int i = 0;
+        for (; i + 4 <= pairs; i += 4) {
+            parlcd_write_data2x(lcd_membase, PACK_PIXELS(src[0], src[1]));
+            parlcd_write_data2x(lcd_membase, PACK_PIXELS(src[2], src[3]));
+            parlcd_write_data2x(lcd_membase, PACK_PIXELS(src[4], src[5]));
+            parlcd_write_data2x(lcd_membase, PACK_PIXELS(src[6], src[7]));
+            src += 8;
+        }
+        for (; i < pairs; i++) {
+            parlcd_write_data2x(lcd_membase, PACK_PIXELS(src[0], src[1]));
+            src += 2;
+        }
+        if (count % 2) {
+            pending = src[0];
+            has_pending = 1;
+        }
+    }
+    if (has_pending) {
+        parlcd_write_data(lcd_membase, pending);
+    }
+}
+
+/**
+ * streams passed number of pixels of one color to the lcd data register \n
+ * two pixels are sent in every write \n
+ * LCD_WRITE command has to be sent before
+ *
+ * @param lcd_membase pointer to base address of lcd display
+ * @param color color of the pixels in rgb 565 format
+ * @param count number of pixels to send
+ */
+void stream_color(unsigned char *lcd_membase, uint16_t color, int count) {
+    uint32_t pair = PACK_PIXELS(color, color);
+    int pairs = count / 2;
+    int i = 0;
+    for (; i + 4 <= pairs; i += 4) {
+        parlcd_write_data2x(lcd_membase, pair);
+        parlcd_write_data2x(lcd_membase, pair);
+        parlcd_write_data2x(lcd_membase, pair);
+        parlcd_write_data2x(lcd_membase, pair);
+    }
+    for (; i < pairs; i++) {
+        parlcd_write_data2x(lcd_membase, pair);
+    }
+    if (count % 2) {
+        parlcd_write_data(lcd_membase, color);
+    }
+}
+
+/**
+ * renders only passed area of frame on the lcd display
+ *
+ * @param frame pointer to frame buffer that has content to be rendered
+ * @param lcd_membase pointer to base address of lcd display to render on
+ * @param rect area of frame to be rendered
+ */
+void show_frame_rect(uint16_t *frame, unsigned char *lcd_membase, rect_t rect) {
+    set_lcd_window(lcd_membase, rect);
+    parlcd_write_cmd(lcd_membase, LCD_WRITE);
+    stream_pixels(lcd_membase, frame, rect);
+}
+
+/**
+ * checks if two areas overlap or share an edge
+ *
+ * @param a first area
+ * @param b second area
+ *
+ * @returns 1 if areas can be merged without covering any gap between them \n
+ *          0 otherwise
+ */
+static int rects_touch(rect_t a, rect_t b) {
+    return a.x <= b.x + b.width && b.x <= a.x + a.width &&
+           a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+/**
+ * computes the smallest area that covers both passed areas
+ *
+ * @param a first area
+ * @param b second area
+ *
+ * @returns bounding area of a and b
+ */
+static rect_t rects_union(rect_t a, rect_t b) {
+    int x = a.x < b.x ? a.x : b.x;
+    int y = a.y < b.y ? a.y : b.y;
+    int x_end = a.x + a.width > b.x + b.width ? a.x + a.width : b.x + b.width;
+    int y_end = a.y + a.height > b.y + b.height ? a.y + a.height : b.y + b.height;
+    return (rect_t){x, y, x_end - x, y_end - y};
+}
+
+/**
+ * marks area of frame as changed \n
+ * area is clipped to the display and merged with areas it touches
+ *
+ * @param damage structure that collects changed areas
+ * @param rect changed area
+ */
+void add_damage(damage_t *damage, rect_t rect) {
+    /* clip the area to the display */
+    if (rect.x < 0) {
+        rect.width += rect.x;
+        rect.x = 0;
+    }
+    if (rect.y < 0) {
+        rect.height += rect.y;
+        rect.y = 0;
+    }
+    if (rect.x + rect.width > LCD_WIDTH) rect.width = LCD_WIDTH - rect.x;
+    if (rect.y + rect.height > LCD_HEIGHT) rect.height = LCD_HEIGHT - rect.y;
+    if (rect.width <= 0 || rect.height <= 0) return;
+    /* merge with every area it touches, merged area can touch other areas again */
+    int i = 0;
+    while (i < damage->count) {
+        if (rects_touch(damage->rects[i], rect)) {
+            rect = rects_union(damage->rects[i], rect);
+            damage->rects[i] = damage->rects[--damage->count];
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+    if (damage->count == MAX_DAMAGE_RECTS) {
+        /* out of space, the last area grows to cover the new one */
+        damage->rects[damage->count - 1] = rects_union(damage->rects[damage->count - 1], rect);
+    } else {
+        damage->rects[damage->count++] = rect;
+    }
+}
+
+/**
+ * marks whole frame as changed
+ *
+ * @param damage structure that collects changed areas
+ */
+void add_full_damage(damage_t *damage) {
+    damage->rects[0] = (rect_t){0, 0, LCD_WIDTH, LCD_HEIGHT};
+    damage->count = 1;
+}
+
+/**
+ * renders all changed areas of frame on the lcd display and forgets them
+ *
+ * @param frame pointer to frame buffer that has content to be rendered
+ * @param lcd_membase pointer to base address of lcd display to render on
+ * @param damage structure that holds changed areas
+ */
+void show_damage(uint16_t *frame, unsigned char *lcd_membase, damage_t *damage) {
+    for (int i = 0; i < damage->count; i++) {
+        show_frame_rect(frame, lcd_membase, damage->rects[i]);
     }
+    damage->count = 0;
 }
 
 /**
@@ -64,10 +272,9 @@ void show_frame(uint16_t *frame, unsigned char *lcd_membase) {
  * @param lcd_membase pointer to base memory of display to clear
  */
 void reset_lcd(unsigned char *lcd_membase) {
+    set_lcd_window(lcd_membase, (rect_t){0, 0, LCD_WIDTH, LCD_HEIGHT});
     parlcd_write_cmd(lcd_membase, LCD_WRITE);
-    for (int i = 0; i < LCD_HEIGHT * LCD_WIDTH; i++) {
-        parlcd_write_data(lcd_membase, 0x0u);
-    }
+    stream_color(lcd_membase, 0x0u, LCD_HEIGHT * LCD_WIDTH);
 }
 
 /**
@@ -135,8 +342,8 @@ void create_result_page(int left_lives, int right_lives, int max_lives, uint16_t
     put_string((LCD_WIDTH - get_string_width(&font_wArial_88, RESULT_HEADLINE)) / 2, 20, frame, &font_wArial_88, RESULT_HEADLINE, BLUE, BACKGROUND);
     char *winner = left_lives > right_lives ? LEFT_WINNER : RIGHT_WINNER;
     put_string((LCD_WIDTH - get_string_width(&font_wArial_44, winner)) / 2, 108, frame, &font_wArial_44, winner, winner_color, BACKGROUND);
-    char result[6];
-    if (!sprintf(result, "%c - %c", (char)(max_lives - right_lives + '0'), (char)(max_lives - left_lives + '0'))) {
+    char result[26];
+    if (sprintf(result, "%d - %d", max_lives - right_lives, max_lives - left_lives) < 0) {
         print_log(GRAPHICS_HEADER, "result page sprintf error");
         exit(1);
     }
@@ -212,17 +419,3 @@ void create_start_game_page(settings_t *settings, uint16_t *frame, unsigned char
     player = settings->right == PLAYER ? "PLAYER" : settings->ai_label;
     put_string((LCD_WIDTH - get_string_width(smallfont, player)) / 2, 256, frame, smallfont, player, settings->paddlecolors[1], BACKGROUND);
 }
-
-/**
- * adds end message to frame, displays it and waits for any key press
- *
- * @param frame pointer to frame buffer to put result page pixels in
- * @param lcd_membase base memory to mapped lcd display
- * @param knobs structure that enables getting input from knobs on the board
- */
-void show_and_wait(uint16_t *frame, unsigned char *lcd_membase, knobs_t *knobs) {
-    put_string((LCD_WIDTH - get_string_width(&font_wArial_44, END_MESSAGE)) / 2, SHOW_AND_WAIT_Y_OFFSET, frame, &font_wArial_44, END_MESSAGE, GREY, BACKGROUND);
-    show_frame(frame, lcd_membase);
-    char c;
-    while (read(STDIN_FILENO, &c, 1) != 1 && !knobs_pushed(knobs)) {}
-}
@@ -24,6 +24,14 @@
 #define LCD_WIDTH 480
 #define LCD_HEIGHT 320
 #define LCD_WRITE 0x2c
+#define LCD_COLUMN_ADDRESS_SET 0x2a
+#define LCD_PAGE_ADDRESS_SET 0x2b
+
+#define MAX_DAMAGE_RECTS 16
+
+/* two pixels sent in one 32bit write to the lcd data register, \n
+ * the first pixel is in the lower half (same as two neighbouring pixels read from memory as one word) */
+#define PACK_PIXELS(first, second) ((uint32_t)(first) | ((uint32_t)(second) << 16))
 
 #define BACKGROUND EMPTY
 
@@ -50,6 +58,31 @@
 
 #define SHOW_AND_WAIT_Y_OFFSET (270)
 
+/**
+ * structure that describes rectangular area of the lcd display
+ */
+typedef struct rect {
+    /** horizontal coordinate of top-left corner */
+    int x;
+    /** vertical coordinate of top-left corner */
+    int y;
+    /** width of the area in pixels */
+    int width;
+    /** height of the area in pixels */
+    int height;
+} rect_t;
+
+/**
+ * structure that holds areas of frame that changed since they were last shown \n
+ * touching and overlapping areas are merged into one
+ */
+typedef struct damage {
+    /** changed areas of the frame */
+    rect_t rects[MAX_DAMAGE_RECTS];
+    /** number of valid items in rects */
+    int count;
+} damage_t;
+
 /**
  * wraps around function from "mzapo_phys.h" that maps lcd address to memory \n
  * exits program if lcd was not mapped properly
@@ -81,6 +114,72 @@ void destroy_frame(uint16_t *frame);
  */
 void show_frame(uint16_t *frame, unsigned char *lcd_membase);
 
+/**
+ * sets area of the lcd display that is written by following LCD_WRITE command \n
+ * pixels are then consumed row by row from top-left corner of the area
+ *
+ * @param lcd_membase pointer to base address of lcd display
+ * @param rect area of the display that will be written
+ */
+void set_lcd_window(unsigned char *lcd_membase, rect_t rect);
+
+/**
+ * streams pixels of passed area of frame to the lcd data register \n
+ * two pixels are sent in every write, pairs continue over row ends so only
+ * an area with odd number of pixels needs one single pixel write at its end \n
+ * LCD_WRITE command has to be sent before and the window has to match the area
+ *
+ * @param lcd_membase pointer to base address of lcd display
+ * @param frame pointer to frame buffer with pixels to be sent
+ * @param rect area of frame to be sent
+ */
+void stream_pixels(unsigned char *lcd_membase, uint16_t *frame, rect_t rect);
+
+/**
+ * streams passed number of pixels of one color to the lcd data register \n
+ * two pixels are sent in every write \n
+ * LCD_WRITE command has to be sent before
+ *
+ * @param lcd_membase pointer to base address of lcd display
+ * @param color color of the pixels in rgb 565 format
+ * @param count number of pixels to send
+ */
+void stream_color(unsigned char *lcd_membase, uint16_t color, int count);
+
+/**
+ * renders only passed area of frame on the lcd display
+ *
+ * @param frame pointer to frame buffer that has content to be rendered
+ * @param lcd_membase pointer to base address of lcd display to render on
+ * @param rect area of frame to be rendered
+ */
+void show_frame_rect(uint16_t *frame, unsigned char *lcd_membase, rect_t rect);
+
+/**
+ * marks area of frame as changed \n
+ * area is clipped to the display and merged with areas it touches
+ *
+ * @param damage structure that collects changed areas
+ * @param rect changed area
+ */
+void add_damage(damage_t *damage, rect_t rect);
+
+/**
+ * marks whole frame as changed
+ *
+ * @param damage structure that collects changed areas
+ */
+void add_full_damage(damage_t *damage);
+
+/**
+ * renders all changed areas of frame on the lcd display and forgets them
+ *
+ * @param frame pointer to frame buffer that has content to be rendered
+ * @param lcd_membase pointer to base address of lcd display to render on
+ * @param damage structure that holds changed areas
+ */
+void show_damage(uint16_t *frame, unsigned char *lcd_membase, damage_t *damage);
+
 /**
  * clears lcd display (turns it to black)
  *
@@ -173,13 +272,4 @@ void create_not_highscore_page(int score, int highscore, uint16_t player_color,
  */
 void create_start_game_page(settings_t *settings, uint16_t *frame, unsigned char* lcd_membase, font_descriptor_t *bigfont, font_descriptor_t *smallfont);
 
-/**
- * adds end message to frame, displays it and waits for any key press
- *
- * @param frame pointer to frame buffer to put result page pixels in
- * @param lcd_membase base memory to mapped lcd display
- * @param knobs structure that enables getting input from knobs on the board
- */
-void show_and_wait(uint16_t *frame, unsigned char *lcd_membase, knobs_t *knobs);
-
 #endif
@@ -0,0 +1,257 @@
+/** @file
+*/
+
+#define _GNU_SOURCE
+
+#include "headless.h"
+#include "settings.h"
+#include "ai_registry.h"
+#include "human_ai.h"
+#include "tick_scheduler.h"
+#include "log.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Work shared by the threads of one run, the threads take the matches one by one.
+ */
+struct headless_work {
+    settings_t* settings;
+    int* ai;
+    unsigned int seed;
+    int match_count;
+    int next_match;
+    match_result_t* results;
+};
+
+void* headless_worker(void* arg);
+void sum_results(match_result_t* results, int match_count, headless_report_t* report);
+
+/**
+ * Seed of the match with the given index, so that every match can be replayed on its own.
+ * @param seed the seed of the whole run
+ * @param match the index of the match
+ */
+unsigned int match_seed(unsigned int seed, int match) {
+    // spread neighbouring indexes over the whole range (the finalizer of murmur3)
+    unsigned int x = seed + 0x9e3779b9u * (unsigned int)(match + 1);
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * Play one match until one side loses all lives or HEADLESS_MAX_TICKS updates have run.
+ * @param settings the settings of the match, both sides have to be bots
+ * @param ai the AI of the left and of the right paddle
+ * @param seed the seed of the match
+ * @param result the result of the match is stored here
+ */
+void play_match(settings_t* settings, int ai[2], unsigned int seed, match_result_t* result) {
+    game_ctx_t ctx;
+    struct tick_input no_input;
+    memset(&no_input, 0, sizeof(no_input));
+    init_game_ctx(&ctx, settings, NULL, seed);
+    ctx.logging = 0;
+    set_game_ai(&ctx, 0, ai[0]);
+    set_game_ai(&ctx, 1, ai[1]);
+    while (ctx.stats.ticks < HEADLESS_MAX_TICKS && update(&ctx, no_input));
+    result->seed = seed;
+    result->stats = ctx.stats;
+    result->lives_left = ctx.data.lives_left;
+    result->lives_right = ctx.data.lives_right;
+    destroy_game_ctx(&ctx);
+}
+
+/**
+ * Play the given number of matches on a pool of threads as fast as possible.
+ * @param settings the settings of the matches, the sides are set to bots
+ * @param ai the AI of the left and of the right paddle
+ * @param seed the seed of the run, match i uses match_seed(seed, i)
+ * @param match_count the number of matches to be played
+ * @param thread_count the number of threads, 0 for one thread per online cpu core
+ * @param results array of match_count results to be filled, can be NULL
+ * @param report the outcome statistics of the run are stored here
+ * @return 0 on success, -1 on error
+ */
+int run_headless(settings_t* settings, int ai[2], unsigned int seed, int match_count, int thread_count, match_result_t* results, headless_report_t* report) {
+    settings_t match_settings = *settings;
+    match_settings.left = BOT;
+    match_settings.right = BOT;
+    if (thread_count <= 0) thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (thread_count <= 0) thread_count = 1;
+    if (thread_count > match_count) thread_count = match_count > 0 ? match_count : 1;
+    match_result_t* own_results = NULL;
+    if (!results) {
+        own_results = (match_result_t*)malloc(match_count * sizeof(match_result_t));
+        if (!own_results && match_count > 0) {
+            print_log(LOG_HEAD_HEADLESS, "ERROR: results not allocated");
+            return -1;
+        }
+        results = own_results;
+    }
+    pthread_t* threads = (pthread_t*)malloc(thread_count * sizeof(pthread_t));
+    if (!threads) {
+        print_log(LOG_HEAD_HEADLESS, "ERROR: threads not allocated");
+        free(own_results);
+        return -1;
+    }
+    struct headless_work work = {&match_settings, ai, seed, match_count, 0, results};
+    long long start = monotonic_ns();
+    int started = 0;
+    for (; started < thread_count; started++) {
+        if (pthread_create(&threads[started], NULL, headless_worker, &work)) break;
+    }
+    // without any thread the matches are played here
+    if (!started) headless_worker(&work);
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    long long end = monotonic_ns();
+    free(threads);
+    sum_results(results, match_count, report);
+    report->seconds = (double)(end - start) / NSEC_PER_SEC;
+    free(own_results);
+    return 0;
+}
+
+/**
+ * Take matches from the shared work until all of them are played.
+ * @param arg pointer to the struct headless_work of the run
+ */
+void* headless_worker(void* arg) {
+    struct headless_work* work = (struct headless_work*)arg;
+    int match;
+    while ((match = __atomic_fetch_add(&work->next_match, 1, __ATOMIC_RELAXED)) < work->match_count) {
+        play_match(work->settings, work->ai, match_seed(work->seed, match), &work->results[match]);
+    }
+    return NULL;
+}
+
+/**
+ * Sum the results of the matches into the report, in the order of the matches.
+ * @param results the results of the matches
+ * @param match_count the number of matches
+ * @param report the report to be filled
+ */
+void sum_results(match_result_t* results, int match_count, headless_report_t* report) {
+    memset(report, 0, sizeof(headless_report_t));
+    report->matches = match_count;
+    for (int i = 0; i < match_count; i++) {
+        struct game_stats* stats = &results[i].stats;
+        if (stats->winner >= 0) {
+            report->wins[stats->winner]++;
+        } else {
+            report->draws++;
+        }
+        report->ticks += stats->ticks;
+        report->hits[0] += stats->hits[0];
+        report->hits[1] += stats->hits[1];
+        report->rallies += stats->rallies;
+        if (stats->longest_rally > report->longest_rally) report->longest_rally = stats->longest_rally;
+    }
+}
+
+/**
+ * Print the outcome statistics of a run.
+ * @param report the statistics to be printed
+ * @param ai_labels the names of the AI of the left and of the right paddle
+ */
+void print_headless_report(headless_report_t* report, char* ai_labels[2]) {
+    int matches = report->matches > 0 ? report->matches : 1;
+    long long rallies = report->rallies > 0 ? report->rallies : 1;
+    printf("matches          %d\n", report->matches);
+    printf("left  (%-6s)   wins %d (%.1f%%), hits %lld\n", ai_labels[0], report->wins[0], 100.0 * report->wins[0] / matches, report->hits[0]);
+    printf("right (%-6s)   wins %d (%.1f%%), hits %lld\n", ai_labels[1], report->wins[1], 100.0 * report->wins[1] / matches, report->hits[1]);
+    printf("draws            %d\n", report->draws);
+    printf("rallies          %lld, %.2f hits per rally, longest %d hits\n", report->rallies,
+           (double)(report->hits[0] + report->hits[1]) / rallies, report->longest_rally);
+    printf("ticks            %lld, %.1f per match\n", report->ticks, (double)report->ticks / matches);
+    printf("time             %.3f s, %.0f ticks/s\n", report->seconds, report->seconds > 0 ? report->ticks / report->seconds : 0.0);
+}
+
+/**
+ * Entry point of "pong --headless [-n matches] [-s seed] [-t threads] [-d difficulty] [-l ai] [-r ai] [-b balls]
+ * [-w ai] [-D delay] [-j jitter] [-a accel]", the last four configure the human AI, see human_ai.h.
+ * @return exit status of the program
+ */
+int headless_main(int argc, char* argv[]) {
+    int match_count = 1000;
+    unsigned int seed = 1;
+    int thread_count = 0;
+    settings_t* settings = init_settings();
+    int ai[2] = {settings->ai, settings->ai};
+    human_ai_config_t human;
+    get_human_ai_config(&human);
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:t:d:l:r:b:w:D:j:a:")) != -1) {
+        switch (opt) {
+            case 'n':
+                match_count = atoi(optarg);
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                thread_count = atoi(optarg);
+                break;
+            case 'd':
+                settings->difficulty = atoi(optarg);
+                break;
+            case 'l':
+                ai[0] = atoi(optarg);
+                break;
+            case 'r':
+                ai[1] = atoi(optarg);
+                break;
+            case 'b':
+                settings->ball_count = atoi(optarg);
+                break;
+            case 'w':
+                human.ai = atoi(optarg);
+                break;
+            case 'D':
+                human.delay = atoi(optarg);
+                break;
+            case 'j':
+                human.jitter = atoi(optarg);
+                break;
+            case 'a':
+                human.accel = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: pong --headless [-n matches] [-s seed] [-t threads] [-d difficulty 0-%d] [-l ai 0-%d] [-r ai 0-%d] [-b balls 1-%d]\n"
+                        "                     [-w ai wrapped by the human ai] [-D delay 0-%d] [-j jitter 0-%d] [-a accel 1-%d]\n",
+                        DIFFICULTY_COUNT - 1, get_ai_count() - 1, get_ai_count() - 1, MAX_BALLS, HUMAN_AI_RING_SIZE - 1,
+                        HUMAN_AI_RING_SIZE - 1, HUMAN_AI_SPEED_ONE);
+                destroy_settings(settings);
+                return 1;
+        }
+    }
+    if (match_count < 0 || settings->difficulty < 0 || settings->difficulty >= DIFFICULTY_COUNT
+        || !get_ai(ai[0]) || !get_ai(ai[1]) || settings->ball_count < 1 || settings->ball_count > MAX_BALLS) {
+        fprintf(stderr, "invalid match count, difficulty, ai or number of balls\n");
+        destroy_settings(settings);
+        return 1;
+    }
+    if (set_human_ai_config(&human)) {
+        fprintf(stderr, "invalid configuration of the human ai\n");
+        destroy_settings(settings);
+        return 1;
+    }
+    settings_fields_t* settings_fields = init_settings_fields();
+    headless_report_t report;
+    int ret = run_headless(settings, ai, seed, match_count, thread_count, NULL, &report);
+    if (!ret) {
+        char* labels[2] = {settings_fields->ai_labels[ai[0]], settings_fields->ai_labels[ai[1]]};
+        printf("difficulty       %s, seed %u\n", settings_fields->difficulties[settings->difficulty], seed);
+        print_headless_report(&report, labels);
+    }
+    destroy_settings_fields(settings_fields);
+    destroy_settings(settings);
+    return ret ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+/** @file
+ * Plays games of two bots without the view, without the leds and without pacing the updates. \n
+ * The matches are spread over a pool of threads, each match has its own game context and seed.
+ */
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "game.h"
+
+// a match that is not decided after this many updates ends as a draw (30 minutes of game time)
+#define HEADLESS_MAX_TICKS (UPDATES_PER_SECOND * 60 * 30)
+
+#define LOG_HEAD_HEADLESS "HEADLESS: "
+
+/**
+ * Result of one match.
+ */
+typedef struct match_result {
+    unsigned int seed;
+    struct game_stats stats;
+    int lives_left, lives_right;
+} match_result_t;
+
+/**
+ * Outcome statistics of all matches of one run.
+ */
+typedef struct headless_report {
+    int matches;
+    /** matches won by the left side and by the right side */
+    int wins[2];
+    /** matches stopped after HEADLESS_MAX_TICKS */
+    int draws;
+    long long ticks;
+    long long hits[2];
+    long long rallies;
+    int longest_rally;
+    /** wall time of the run in seconds */
+    double seconds;
+} headless_report_t;
+
+/**
+ * Seed of the match with the given index, so that every match can be replayed on its own.
+ * @param seed the seed of the whole run
+ * @param match the index of the match
+ */
+unsigned int match_seed(unsigned int seed, int match);
+
+/**
+ * Play one match until one side loses all lives or HEADLESS_MAX_TICKS updates have run.
+ * @param settings the settings of the match, both sides have to be bots
+ * @param ai the AI of the left and of the right paddle
+ * @param seed the seed of the match
+ * @param result the result of the match is stored here
+ */
+void play_match(settings_t* settings, int ai[2], unsigned int seed, match_result_t* result);
+
+/**
+ * Play the given number of matches on a pool of threads as fast as possible.
+ * @param settings the settings of the matches, the sides are set to bots
+ * @param ai the AI of the left and of the right paddle
+ * @param seed the seed of the run, match i uses match_seed(seed, i)
+ * @param match_count the number of matches to be played
+ * @param thread_count the number of threads, 0 for one thread per online cpu core
+ * @param results array of match_count results to be filled, can be NULL
+ * @param report the outcome statistics of the run are stored here
+ * @return 0 on success, -1 on error
+ */
+int run_headless(settings_t* settings, int ai[2], unsigned int seed, int match_count, int thread_count, match_result_t* results, headless_report_t* report);
+
+/**
+ * Print the outcome statistics of a run.
+ * @param report the statistics to be printed
+ * @param ai_labels the names of the AI of the left and of the right paddle
+ */
+void print_headless_report(headless_report_t* report, char* ai_labels[2]);
+
+/**
+ * Entry point of "pong --headless [-n matches] [-s seed] [-t threads] [-d difficulty] [-l ai] [-r ai] [-b balls]
+ * [-w ai] [-D delay] [-j jitter] [-a accel]", the last four configure the human AI, see human_ai.h.
+ * @return exit status of the program
+ */
+int headless_main(int argc, char* argv[]);
+
+#endif
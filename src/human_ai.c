@@ -0,0 +1,202 @@
+/** @file
+*/
+
+#include "human_ai.h"
+#include "ai_registry.h"
+#include "settings.h"
+#include <stdlib.h>
+#include <string.h>
+
+// the ball is stored in 1/64 of a pixel, it fits into 16 bits anywhere in the court
+#define RING_SHIFT (FIXED_SHIFT - 6)
+
+/**
+ * State of one paddle, kept in its struct ai_state.
+ */
+struct human_ai_state {
+    /** the configuration taken when the paddle got the AI */
+    int32_t ai, delay, jitter, accel;
+    /** the number of updates stored in the ring so far */
+    int32_t ticks;
+    /** the update whose ball the wrapped AI sees */
+    int32_t seen;
+    /** the speed of the paddle, HUMAN_AI_SPEED_ONE is one step in every update */
+    int32_t speed;
+    /** the part of a step travelled and not moved yet, from -HUMAN_AI_SPEED_ONE / 2 to HUMAN_AI_SPEED_ONE / 2 */
+    int32_t travel;
+    /** the ring of the balls of the last updates, update i is at i % HUMAN_AI_RING_SIZE */
+    int16_t ball_x[HUMAN_AI_RING_SIZE], ball_y[HUMAN_AI_RING_SIZE];
+    int16_t vel_x[HUMAN_AI_RING_SIZE], vel_y[HUMAN_AI_RING_SIZE];
+    /** the state of the wrapped AI */
+    int32_t inner[HUMAN_AI_INNER_WORDS];
+};
+
+_Static_assert(sizeof(struct human_ai_state) <= sizeof(struct ai_state), "the state of human_ai does not fit into struct ai_state");
+
+void human_ai_init(struct ai_state* ai_state, char is_right);
+void human_ai_destroy(struct ai_state* ai_state);
+void human_ai_refocus(struct ai_state* ai_state, char is_right);
+void see_ball(struct human_ai_state* state, struct game_data* game_data, unsigned int* seed);
+char limit_acceleration(struct human_ai_state* state, char dir);
+
+const ai_interface_t human_ai = {"HUMAN", sizeof(struct human_ai_state), human_ai_init, human_ai_move, human_ai_destroy, human_ai_refocus};
+
+static human_ai_config_t config = {SMARTER_AI, HUMAN_AI_DEFAULT_DELAY, HUMAN_AI_DEFAULT_JITTER, HUMAN_AI_DEFAULT_ACCEL};
+
+/**
+ * Take the configuration and prepare the state of the wrapped AI.
+ * @param ai_state the zeroed state of the paddle
+ * @param is_right 0 if the AI controls the left paddle, 1 if the AI controls the right paddle
+ */
+void human_ai_init(struct ai_state* ai_state, char is_right) {
+    struct human_ai_state* state = (struct human_ai_state*)ai_state->words;
+    state->ai = config.ai;
+    state->delay = config.delay;
+    state->jitter = config.jitter;
+    state->accel = config.accel;
+    const ai_interface_t* inner = get_ai(state->ai);
+    if (!inner->init) return;
+    struct ai_state inner_state;
+    memset(&inner_state, 0, sizeof(inner_state));
+    inner->init(&inner_state, is_right);
+    memcpy(state->inner, inner_state.words, sizeof(state->inner));
+}
+
+/**
+ * Let the wrapped AI release its state.
+ * @param ai_state the state of the paddle
+ */
+void human_ai_destroy(struct ai_state* ai_state) {
+    struct human_ai_state* state = (struct human_ai_state*)ai_state->words;
+    const ai_interface_t* inner = get_ai(state->ai);
+    if (!inner || !inner->destroy) return;
+    struct ai_state inner_state;
+    memcpy(inner_state.words, state->inner, sizeof(state->inner));
+    inner->destroy(&inner_state);
+}
+
+/**
+ * Let the wrapped AI follow a new ball. \n
+ * Only the state of the wrapped AI starts again, the ring and the speed of the paddle are kept,
+ * so the new ball is seen with the delay and the paddle does not stop at once.
+ * @param ai_state the state of the paddle
+ * @param is_right 0 if the AI controls the left paddle, 1 if the AI controls the right paddle
+ */
+void human_ai_refocus(struct ai_state* ai_state, char is_right) {
+    struct human_ai_state* state = (struct human_ai_state*)ai_state->words;
+    const ai_interface_t* inner = get_ai(state->ai);
+    if (!inner) return;
+    struct ai_state inner_state;
+    memcpy(inner_state.words, state->inner, sizeof(state->inner));
+    if (inner->refocus) {
+        inner->refocus(&inner_state, is_right);
+    } else {
+        if (inner->destroy) inner->destroy(&inner_state);
+        memset(&inner_state, 0, sizeof(inner_state));
+        if (inner->init) inner->init(&inner_state, is_right);
+    }
+    memcpy(state->inner, inner_state.words, sizeof(state->inner));
+}
+
+/**
+ * This funciton is called every game update to determine the AI's movement. \n
+ * It is the move function of the AI, see ai_interface.h.
+ * @param is_right 0 if the AI controls the left paddle, \n
+ *                 1 if the AI controls the right paddle
+ * @param game_data a structure containing all information about the state of the game
+ * @param ai_state the state the AI keeps between updates for this paddle
+ * @param seed the state of the random numbers of the game, to be used with rand_r
+ * @return -1 for moving up \n
+ *          0 for not moving \n
+ *          1 for moving down
+ * @see game.h for struct game_data and struct ai_state
+ */
+char human_ai_move(char is_right, struct game_data game_data, struct ai_state* ai_state, unsigned int* seed) {
+    struct human_ai_state* state = (struct human_ai_state*)ai_state->words;
+    const ai_interface_t* inner = get_ai(state->ai);
+    if (!inner) return 0;
+    see_ball(state, &game_data, seed);
+    // the wrapped AI uses only the start of its state, the rest is not copied
+    struct ai_state inner_state;
+    memcpy(inner_state.words, state->inner, sizeof(state->inner));
+    char dir = inner->move(is_right, game_data, &inner_state, seed);
+    memcpy(state->inner, inner_state.words, sizeof(state->inner));
+    return limit_acceleration(state, dir);
+}
+
+/**
+ * Store the current ball in the ring and replace it in the game data by the delayed one.
+ * @param state the state of the paddle
+ * @param game_data the game data given to the AI, changed to the game data seen by the wrapped AI
+ * @param seed the state of the random numbers of the game
+ */
+void see_ball(struct human_ai_state* state, struct game_data* game_data, unsigned int* seed) {
+    int slot = state->ticks % HUMAN_AI_RING_SIZE;
+    state->ball_x[slot] = game_data->ball_pos_x >> RING_SHIFT;
+    state->ball_y[slot] = game_data->ball_pos_y >> RING_SHIFT;
+    state->vel_x[slot] = game_data->ball_vel_x >> RING_SHIFT;
+    state->vel_y[slot] = game_data->ball_vel_y >> RING_SHIFT;
+    state->ticks++;
+    int delay = state->delay;
+    if (state->jitter) delay += rand_r(seed) % (2 * state->jitter + 1) - state->jitter;
+    if (delay < 0) delay = 0;
+    if (delay > HUMAN_AI_RING_SIZE - 1) delay = HUMAN_AI_RING_SIZE - 1;
+    // before the ring is full the first ball is seen, a shorter delay never shows an older ball again
+    int seen = state->ticks - 1 - delay;
+    if (seen > state->seen) state->seen = seen;
+    slot = state->seen % HUMAN_AI_RING_SIZE;
+    game_data->ball_pos_x = (fixed_t)state->ball_x[slot] * (1 << RING_SHIFT);
+    game_data->ball_pos_y = (fixed_t)state->ball_y[slot] * (1 << RING_SHIFT);
+    game_data->ball_vel_x = (fixed_t)state->vel_x[slot] * (1 << RING_SHIFT);
+    game_data->ball_vel_y = (fixed_t)state->vel_y[slot] * (1 << RING_SHIFT);
+}
+
+/**
+ * Change the speed of the paddle towards the desired direction and turn it into whole steps.
+ * @param state the state of the paddle
+ * @param dir the direction desired by the wrapped AI
+ * @return the step of the paddle in this update
+ */
+char limit_acceleration(struct human_ai_state* state, char dir) {
+    int target = dir * HUMAN_AI_SPEED_ONE;
+    if (state->speed < target) {
+        state->speed = state->speed + state->accel < target ? state->speed + state->accel : target;
+    } else {
+        state->speed = state->speed - state->accel > target ? state->speed - state->accel : target;
+    }
+    state->travel += state->speed;
+    if (state->travel >= HUMAN_AI_SPEED_ONE / 2) {
+        state->travel -= HUMAN_AI_SPEED_ONE;
+        return 1;
+    }
+    if (state->travel <= -HUMAN_AI_SPEED_ONE / 2) {
+        state->travel += HUMAN_AI_SPEED_ONE;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Change the configuration of the human AI, the paddles which have the AI already keep the old one. \n
+ * It is to be called while no game runs on another thread.
+ * @param new_config the new configuration
+ * @return 0 on success, -1 if the configuration is invalid, e.g. the state of the wrapped AI is too large
+ */
+int set_human_ai_config(human_ai_config_t* new_config) {
+    const ai_interface_t* inner = get_ai(new_config->ai);
+    if (!inner || inner == &human_ai || inner->state_size > HUMAN_AI_INNER_WORDS * (int)sizeof(int32_t)
+        || new_config->delay < 0 || new_config->delay > HUMAN_AI_RING_SIZE - 1 || new_config->jitter < 0
+        || new_config->jitter > HUMAN_AI_RING_SIZE - 1 || new_config->accel < 1 || new_config->accel > HUMAN_AI_SPEED_ONE) {
+        return -1;
+    }
+    config = *new_config;
+    return 0;
+}
+
+/**
+ * Get the current configuration of the human AI.
+ * @param current the configuration is stored here
+ */
+void get_human_ai_config(human_ai_config_t* current) {
+    *current = config;
+}
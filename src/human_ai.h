@@ -0,0 +1,78 @@
+#ifndef HUMAN_AI_H
+#define HUMAN_AI_H
+
+/** @file
+ * This is an implementation of ai_interface.h \n
+ * The AI plays like a person: it wraps another AI of the registry, which sees the ball late and whose moves
+ * are turned into a paddle that speeds up and slows down gradually. \n
+ * Every update the ball of the game data is stored in a ring buffer of HUMAN_AI_RING_SIZE updates in the state
+ * of the paddle and the wrapped AI gets the ball as it was the delay of the configuration ago, to 1/64 of a pixel,
+ * the paddles and lives are the current ones. With jitter the delay of each update is chosen at random from delay - jitter
+ * to delay + jitter, but the seen ball never goes back in time. The move of the wrapped AI is the desired direction,
+ * the speed of the paddle follows it by at most the acceleration per update and the whole steps the game allows
+ * are spread over the updates, so e.g. half of the speed moves the paddle every other update. \n
+ * Nothing is allocated, an update costs one move of the wrapped AI and a few integer operations.
+ */
+
+#include "ai_interface.h"
+
+// the number of updates kept, the delay can be at most HUMAN_AI_RING_SIZE - 1 updates
+#define HUMAN_AI_RING_SIZE (16)
+// the size of the state of the wrapped AI in 32-bit words
+#define HUMAN_AI_INNER_WORDS (16)
+// the full speed of the paddle, the speeds and accelerations are in these units
+#define HUMAN_AI_SPEED_ONE (256)
+
+/* the default configuration wraps the smarter AI with a reaction time of about 200 ms
+ * and a paddle at full speed after 4 updates */
+#define HUMAN_AI_DEFAULT_DELAY (10)
+#define HUMAN_AI_DEFAULT_JITTER (3)
+#define HUMAN_AI_DEFAULT_ACCEL (HUMAN_AI_SPEED_ONE / 4)
+
+/**
+ * Configuration of the human AI, it is read when a paddle gets the AI.
+ */
+typedef struct human_ai_config {
+    /** the id of the wrapped AI in the registry of ai_registry.h */
+    int ai;
+    /** the delay of the seen ball in updates, from 0 to HUMAN_AI_RING_SIZE - 1 */
+    int delay;
+    /** the largest random change of the delay in one update, from 0 to HUMAN_AI_RING_SIZE - 1 */
+    int jitter;
+    /** the largest change of the speed of the paddle in one update, from 1 to HUMAN_AI_SPEED_ONE */
+    int accel;
+} human_ai_config_t;
+
+/**
+ * This funciton is called every game update to determine the AI's movement. \n
+ * It is the move function of the AI, see ai_interface.h.
+ * @param is_right 0 if the AI controls the left paddle, \n
+ *                 1 if the AI controls the right paddle
+ * @param game_data a structure containing all information about the state of the game
+ * @param state the state the AI keeps between updates for this paddle
+ * @param seed the state of the random numbers of the game, to be used with rand_r
+ * @return -1 for moving up \n
+ *          0 for not moving \n
+ *          1 for moving down
+ * @see game.h for struct game_data and struct ai_state
+ */
+char human_ai_move(char is_right, struct game_data game_data, struct ai_state* state, unsigned int* seed);
+
+/** the AI wrapping another one to play like a person */
+extern const ai_interface_t human_ai;
+
+/**
+ * Change the configuration of the human AI, the paddles which have the AI already keep the old one. \n
+ * It is to be called while no game runs on another thread.
+ * @param config the new configuration
+ * @return 0 on success, -1 if the configuration is invalid, e.g. the state of the wrapped AI is too large
+ */
+int set_human_ai_config(human_ai_config_t* config);
+
+/**
+ * Get the current configuration of the human AI.
+ * @param config the configuration is stored here
+ */
+void get_human_ai_config(human_ai_config_t* config);
+
+#endif
@@ -4,6 +4,93 @@
  */
 
 #include "menu.h"
+#include "menu_events.h"
+
+/**
+ * one drawn row of the menu kept by the renderer
+ */
+typedef struct row_bitmap {
+    /** the row that is drawn */
+    menu_row_t row;
+    /** value of bitmap_clock when the bitmap was last used, 0 for a bitmap not used yet */
+    unsigned long used;
+    /** pixels of the row, LCD_WIDTH * MENU_ROW_HEIGHT, NULL until the bitmap is used */
+    uint16_t *pixels;
+} row_bitmap_t;
+
+int same_menu_item(menu_row_t *a, menu_row_t *b);
+void draw_menu_row(int y, menu_row_t *row, uint16_t *frame);
+void log_menu_change(const menu_t *menu, const menu_item_t *item, menu_ctx_t *ctx);
+uint16_t step_color(settings_fields_t *settings_fields, uint16_t color, int step);
+void get_difficulty_setting(menu_ctx_t *ctx, menu_row_t *row);
+void set_difficulty_setting(menu_ctx_t *ctx, int step);
+void get_ai_setting(menu_ctx_t *ctx, menu_row_t *row);
+void set_ai_setting(menu_ctx_t *ctx, int step);
+void get_ball_color(menu_ctx_t *ctx, menu_row_t *row);
+void set_ball_color(menu_ctx_t *ctx, int step);
+void get_left_color(menu_ctx_t *ctx, menu_row_t *row);
+void set_left_color(menu_ctx_t *ctx, int step);
+void get_right_color(menu_ctx_t *ctx, menu_row_t *row);
+void set_right_color(menu_ctx_t *ctx, int step);
+void get_highscore_ai(menu_ctx_t *ctx, menu_row_t *row);
+void set_highscore_ai(menu_ctx_t *ctx, int step);
+void get_highscore(menu_ctx_t *ctx, menu_row_t *row);
+int choose_game_mode(menu_ctx_t *ctx, int mode);
+int close_menu(menu_ctx_t *ctx, int arg);
+int quit_menus(menu_ctx_t *ctx, int arg);
+
+/* what the rows on the screen show, a row with NULL label is drawn by the next fill */
+static menu_row_t menu_rows[ITEMS_ON_PAGE];
+/* areas of the frame changed since the menu was last shown */
+static damage_t menu_damage;
+/* drawn rows of the renderer, the one used the longest time ago is replaced */
+static row_bitmap_t row_bitmaps[MENU_BITMAP_COUNT];
+static unsigned long bitmap_clock = 0;
+
+/* sides of the players and numbers of balls of the game modes, indexed by the items of the play menu */
+static const int game_modes[][3] = {
+    [PLAYER_PLAYER] = {IS_PLAYER, IS_PLAYER, 1},
+    [PLAYER_AI] = {IS_PLAYER, IS_AI, 1},
+    [AI_PLAYER] = {IS_AI, IS_PLAYER, 1},
+    /* player against ai with many balls, every lost ball costs a life */
+    [PLAY_MULTI_BALL] = {IS_PLAYER, IS_AI, MULTI_BALL_COUNT},
+};
+
+static const menu_item_t play_items[PLAY_MENU_ITEMS] = {
+    [PLAYER_PLAYER] = {"P vs P", "player-player mode", ROW_PLAIN, NULL, NULL, NULL, choose_game_mode, PLAYER_PLAYER},
+    [PLAYER_AI] = {"P vs A", "player-ai mode", ROW_PLAIN, NULL, NULL, NULL, choose_game_mode, PLAYER_AI},
+    [AI_PLAYER] = {"A vs P", "ai-player mode", ROW_PLAIN, NULL, NULL, NULL, choose_game_mode, AI_PLAYER},
+    [PLAY_MULTI_BALL] = {"MULTI", "multi-ball mode", ROW_PLAIN, NULL, NULL, NULL, choose_game_mode, PLAY_MULTI_BALL},
+    [PLAY_BACK] = {"BACK", "BACK", ROW_PLAIN, NULL, NULL, NULL, close_menu, 0},
+};
+
+static const menu_item_t settings_items[SETTINGS_MENU_ITEMS] = {
+    [DIFFICULTY] = {"", "difficulty", ROW_LABEL, get_difficulty_setting, set_difficulty_setting, NULL, NULL, 0},
+    [SETTINGS_AI] = {"AI", "ai", ROW_SMALL_LABEL, get_ai_setting, set_ai_setting, NULL, NULL, 0},
+    [BALL_COLOR] = {"BALL", "ball color", ROW_COLOR, get_ball_color, set_ball_color, NULL, NULL, 0},
+    [LEFT_COLOR] = {"LEFT", "left paddle color", ROW_COLOR, get_left_color, set_left_color, NULL, NULL, 0},
+    [RIGHT_COLOR] = {"RIGHT", "right paddle color", ROW_COLOR, get_right_color, set_right_color, NULL, NULL, 0},
+    [SETTINGS_BACK] = {"BACK", "BACK", ROW_PLAIN, NULL, NULL, NULL, close_menu, 0},
+};
+
+static const menu_item_t highscore_items[HIGHSCORE_MENU_ITEMS] = {
+    [HIGHSCORE_AI] = {"", "ai", ROW_LABEL, get_highscore_ai, set_highscore_ai, NULL, NULL, 0},
+    [HIGHSCORE_NUMBER] = {"", "highscore", ROW_NUMBER, get_highscore, NULL, NULL, NULL, 0},
+    [HIGHSCORE_BACK] = {"BACK", "BACK", ROW_PLAIN, NULL, NULL, NULL, close_menu, 0},
+};
+
+const menu_t play_menu = {"play menu", PLAY_MENU_HEADER, PLAY_MENU_ITEMS, play_items};
+const menu_t settings_menu = {"settings menu", SETTINGS_MENU_HEADER, SETTINGS_MENU_ITEMS, settings_items};
+const menu_t highscore_menu = {"highscore menu", HIGHSCORE_MENU_HEADER, HIGHSCORE_MENU_ITEMS, highscore_items};
+
+static const menu_item_t main_items[MAIN_MENU_ITEMS] = {
+    [PLAY] = {"PLAY", "PLAY", ROW_PLAIN, NULL, NULL, &play_menu, NULL, 0},
+    [HIGHSCORES] = {"SCORES", "SCORES", ROW_PLAIN, NULL, NULL, &highscore_menu, NULL, 0},
+    [SETTINGS] = {"SETTINGS", "SETTINGS", ROW_PLAIN, NULL, NULL, &settings_menu, NULL, 0},
+    [QUIT] = {"QUIT", "QUIT", ROW_PLAIN, NULL, NULL, NULL, quit_menus, 0},
+};
+
+const menu_t root_menu = {"main menu", MAIN_MENU_HEADER, MAIN_MENU_ITEMS, main_items};
 
 /**
  * puts new item of same format into frame buffer
@@ -41,97 +128,164 @@ void put_menu_element(int y, char *label, uint16_t *frame, font_descriptor_t *fo
 }
 
 /**
- * fills whole screen with number of items (other will not fit) preset in ITEMS_ON_PAGE \n
- * it considers which item is currently selected and tries to place it in the middle of the screen (except first one) \n
- * it is not meant for settings menu
+ * forgets what the rows of the menu show, so the next fill draws all of them \n
+ * it is called when a menu is entered after the frame was cleared, the whole frame is shown then
+ */
+void reset_menu_rows(void) {
+    for (int i = 0; i < ITEMS_ON_PAGE; i++) {
+        menu_rows[i].label = NULL;
+    }
+    add_full_damage(&menu_damage);
+}
+
+/**
+ * draws one row of the menu into frame buffer unless it shows the same already \n
+ * the redrawn part is added to the damage of the menu, only the square changes when just the color of a color item changed
  *
- * @param y_offsets precomputed array of top-left corners of all items (3) on screen
- * @param labels list of strings (double char pointer) that are to be placed into menu items
- * @param count total number of items in the menu (not the number of visible ones)
- * @param selected index of the item that is currently selected
- * @param font pointer to font structure used for writing text
+ * @param index index of the row on the screen
+ * @param y vertical offset of top-left corner of the row
+ * @param row what the row is to show
  * @param frame frame buffer that holds the menu items
  */
-void fill_menu(int *y_offsets, char **labels, int count, int selected, font_descriptor_t *font, uint16_t *frame) {
-    clear_frame(frame);
-    int offset_index = 0;
-    int i = selected == 0 ? 0 : selected - 1;
-    /* compute index of the last item that will be shown */
-    int max = i + ITEMS_ON_PAGE - 1 >= count ? count - 1 : i + ITEMS_ON_PAGE - 1;
-    for (; i <= max; i++) {
-        put_menu_element(y_offsets[offset_index++], labels[i], frame, font, i == selected ? SELECTED : UNSELECTED);
+void update_menu_row(int index, int y, menu_row_t *row, uint16_t *frame) {
+    menu_row_t *shown = &menu_rows[index];
+    if (same_menu_item(shown, row)) {
+        if (shown->value_label == row->value_label && shown->value == row->value) return;
+        if (row->kind == ROW_COLOR) {
+            put_color_settings(y, row->value, row->value_font, frame);
+            add_damage(&menu_damage, get_color_square(y, row->value_font));
+            *shown = *row;
+            return;
+        }
+    }
+    if (row->kind == ROW_BLANK) {
+        for (int i = y * LCD_WIDTH; i < (y + MENU_ROW_HEIGHT) * LCD_WIDTH; i++) {
+            frame[i] = BACKGROUND;
+        }
+    } else {
+        draw_menu_row(y, row, frame);
     }
+    add_damage(&menu_damage, (rect_t){0, y, LCD_WIDTH, MENU_ROW_HEIGHT});
+    *shown = *row;
 }
 
 /**
- * fills whole scrren with number of items preset in ITEMS_ON_PAGE \n
- * items contain different or none interactive aspects
+ * clears the rows of the screen below the last item of the menu
  *
+ * @param index index of the first row on the screen without item
  * @param y_offsets precomputed array of top-left corners of all items (3) on screen
- * @param labels list of strings (double char pointer) that are to be placed into menu items
- * @param ai_label label of ai for which is displayed highscore
- * @param highscore number that represents highscore of selected ai (same as ai_label)
- * @param count total number of items in the menu (not the number of visible ones)
- * @param selected index of the item that is currently selected
- * @param font pointer to font structure used for writing text
  * @param frame frame buffer that holds the menu items
  */
-void fill_highscore_menu(int *y_offsets, char **labels, char *ai_label, int highscore, int count, int selected, font_descriptor_t *font, uint16_t *frame) {
-    clear_frame(frame);
+void clear_menu_rows(int index, int *y_offsets, uint16_t *frame) {
+    menu_row_t row = {"", BACKGROUND, ROW_BLANK, NULL, NULL, NULL, 0};
+    for (; index < ITEMS_ON_PAGE; index++) {
+        update_menu_row(index, y_offsets[index], &row, frame);
+    }
+}
+
+/**
+ * shows the rows of the menu which changed since they were last shown on the lcd display
+ *
+ * @param frame frame buffer that holds the menu items
+ * @param lcd_membase pointer to base memory of the lcd display
+ */
+void show_menu(uint16_t *frame, unsigned char *lcd_membase) {
+    show_menu_frame(frame, lcd_membase, &menu_damage);
+}
+
+/**
+ * fills whole screen with number of items (other will not fit) preset in ITEMS_ON_PAGE \n
+ * it considers which item is currently selected and tries to place it in the middle of the screen (except first one) \n
+ * only the rows that changed are drawn, see update_menu_row
+ *
+ * @param menu menu to fill the screen with
+ * @param selected index of the item that is currently selected
+ * @param ctx structure that holds the settings shown in the items and the frame
+ */
+void fill_menu(const menu_t *menu, int selected, menu_ctx_t *ctx) {
     int offset_index = 0;
     int i = selected == 0 ? 0 : selected - 1;
     /* compute index of the last item that will be shown */
-    int max = i + ITEMS_ON_PAGE - 1 >= count ? count - 1 : i + ITEMS_ON_PAGE - 1;
+    int max = i + ITEMS_ON_PAGE - 1 >= menu->count ? menu->count - 1 : i + ITEMS_ON_PAGE - 1;
     for (; i <= max; i++) {
-        put_menu_element(y_offsets[offset_index], labels[i], frame, font, i == selected ? SELECTED : UNSELECTED);
-        if (i == HIGHSCORE_AI) {
-            put_label_settings(y_offsets[offset_index], ai_label, font, frame, i == selected ? SELECTED : UNSELECTED, CENTER);
-        } else if (i == HIGHSCORE_NUMBER) {
-                char string[11];
-            if (sprintf(string, "%d", highscore) < 0) {
-                print_log(HIGHSCORE_MENU_HEADER, "highscore menu sprintf error");
-                exit(1);
-            }
-            put_string((LCD_WIDTH - get_string_width(font, string)) / 2, y_offsets[offset_index] + 2 * PADDING, frame, font, string, i == selected ? SELECTED : UNSELECTED, MENU_BACKGROUND);
-        }
+        const menu_item_t *item = &menu->items[i];
+        font_descriptor_t *value_font = item->kind == ROW_SMALL_LABEL ? ctx->smallfont : ctx->bigfont;
+        menu_row_t row = {item->label, i == selected ? SELECTED : UNSELECTED, item->kind, ctx->bigfont, value_font, NULL, 0};
+        if (item->get) item->get(ctx, &row);
+        update_menu_row(offset_index, ctx->y_offsets[offset_index], &row, ctx->frame);
         offset_index++;
     }
+    clear_menu_rows(offset_index, ctx->y_offsets, ctx->frame);
 }
 
 /**
- * fills whole screen with number of items preset in ITEMS_ON_PAGE \n
- * items contain different interactive aspect (colro square or different kind of label)
+ * checks if two rows show the same item with the same highlight, the settings in them may differ
  *
- * @param y_offsets precomputed array of top-left corners of all items (3) on screen
- * @param labels list of strings (double char pointer) that are to be placed into menu items
- * @param count total number of items in the menu (not the number of visible ones)
- * @param selected index of the item that is currently selected
- * @param bigfont pointer to font structure used for writing big text
- * @param smallfont pointer to font structure used for writing small text
+ * @param a first row
+ * @param b second row
+ *
+ * @returns 1 if the items are the same, 0 otherwise
+ */
+int same_menu_item(menu_row_t *a, menu_row_t *b) {
+    return a->label == b->label && a->color == b->color && a->kind == b->kind && a->font == b->font && a->value_font == b->value_font;
+}
+
+/**
+ * draws one row of the menu into frame buffer, the bitmap of the row is copied when the same row was drawn before \n
+ * a newly drawn row replaces the bitmap that was used the longest time ago
+ *
+ * @param y vertical offset of top-left corner of the row
+ * @param row what the row is to show
  * @param frame frame buffer that holds the menu items
- * @param settings pointer to structure that hold current settings and is both read and modified
  */
-void fill_settings_menu(int *y_offsets, char **labels, int count, int selected, font_descriptor_t *bigfont, font_descriptor_t *smallfont, uint16_t *frame, settings_t *settings) {
-    clear_frame(frame);
-    int offset_index = 0;
-    int i = selected == 0 ? 0 : selected - 1;
-    /* compute index of the last item that will be shown */
-    int max = i + ITEMS_ON_PAGE - 1 >= count ? count - 1 : i + ITEMS_ON_PAGE - 1;
-    for (; i <= max; i++) {
-        put_menu_element(y_offsets[offset_index], labels[i], frame, bigfont, i == selected ? SELECTED : UNSELECTED);
-        /* check special features of menu item */
-        if (i == BALL_COLOR) {
-            put_color_settings(y_offsets[offset_index], settings->ballcolor, bigfont, frame);
-        } else if (i == LEFT_COLOR) {
-            put_color_settings(y_offsets[offset_index], settings->paddlecolors[0], bigfont, frame);
-        } else if (i == RIGHT_COLOR) {
-            put_color_settings(y_offsets[offset_index], settings->paddlecolors[1], bigfont, frame);
-        } else if (i == DIFFICULTY) {
-            put_label_settings(y_offsets[offset_index], settings->difficulty_label, bigfont, frame, i == selected ? SELECTED : UNSELECTED, CENTER);
-        } else if (i == SETTINGS_AI) {
-            put_label_settings(y_offsets[offset_index] + (MENU_FONT_SIZE - MENU_SMALLFONT_SIZE) / 2, settings->ai_label, smallfont, frame, i == selected ? SELECTED : UNSELECTED, NOT_CENTER);
+void draw_menu_row(int y, menu_row_t *row, uint16_t *frame) {
+    uint16_t *pixels = frame + y * LCD_WIDTH;
+    size_t size = LCD_WIDTH * MENU_ROW_HEIGHT * sizeof(uint16_t);
+    row_bitmap_t *oldest = &row_bitmaps[0];
+    for (int i = 0; i < MENU_BITMAP_COUNT; i++) {
+        row_bitmap_t *bitmap = &row_bitmaps[i];
+        if (bitmap->pixels && same_menu_item(&bitmap->row, row) && bitmap->row.value_label == row->value_label && bitmap->row.value == row->value) {
+            memcpy(pixels, bitmap->pixels, size);
+            bitmap->used = ++bitmap_clock;
+            return;
         }
-        offset_index++;
+        if (bitmap->used < oldest->used) oldest = bitmap;
+    }
+    put_menu_element(y, row->label, frame, row->font, row->color);
+    if (row->kind == ROW_LABEL) {
+        put_label_settings(y, row->value_label, row->value_font, frame, row->color, CENTER);
+    } else if (row->kind == ROW_SMALL_LABEL) {
+        put_label_settings(y + (MENU_FONT_SIZE - MENU_SMALLFONT_SIZE) / 2, row->value_label, row->value_font, frame, row->color, NOT_CENTER);
+    } else if (row->kind == ROW_COLOR) {
+        put_color_settings(y, row->value, row->value_font, frame);
+    } else if (row->kind == ROW_NUMBER) {
+        char string[12];
+        if (sprintf(string, "%d", row->value) < 0) {
+            print_log(HIGHSCORE_MENU_HEADER, "highscore menu sprintf error");
+            exit(1);
+        }
+        put_string((LCD_WIDTH - get_string_width(row->value_font, string)) / 2, y + 2 * PADDING, frame, row->value_font, string, row->color, MENU_BACKGROUND);
+    }
+    if (oldest->pixels == NULL) {
+        oldest->pixels = (uint16_t *)malloc(size);
+        if (oldest->pixels == NULL) {
+            print_log(MENU_HEADER, "error in menu bitmap allocation");
+            exit(1);
+        }
+    }
+    memcpy(oldest->pixels, pixels, size);
+    oldest->row = *row;
+    oldest->used = ++bitmap_clock;
+}
+
+/**
+ * frees the bitmaps of the rows kept by the renderer
+ */
+void destroy_menu_bitmaps(void) {
+    for (int i = 0; i < MENU_BITMAP_COUNT; i++) {
+        free(row_bitmaps[i].pixels);
+        row_bitmaps[i].pixels = NULL;
+        row_bitmaps[i].used = 0;
     }
 }
 
@@ -172,56 +326,128 @@ void put_label_settings(int y_offset, char *label, font_descriptor_t *font, uint
  * @param frame frame buffer that holds the menu items
  */
 void put_color_settings(int y_offset, uint16_t color, font_descriptor_t *font, uint16_t *frame) {
-    y_offset += 2 * PADDING;
+    rect_t square = get_color_square(y_offset, font);
     int width = get_char_width(font, '>');
-    int size = MENU_FONT_SIZE - 8 * PADDING;
-    int x_offset = LCD_WIDTH - 6 * PADDING - width;
-    put_char(x_offset, y_offset, frame, font, '>', GREY, MENU_BACKGROUND);
-    x_offset -= (size + 4 * PADDING);
-    y_offset += 4 * PADDING;
+    put_char(square.x + square.width + 4 * PADDING, y_offset + 2 * PADDING, frame, font, '>', GREY, MENU_BACKGROUND);
     /* place square of passed color */
-    for (int y = y_offset; y < y_offset + size; y++) {
-        for (int x = x_offset; x < x_offset + size; x++) {
+    for (int y = square.y; y < square.y + square.height; y++) {
+        for (int x = square.x; x < square.x + square.width; x++) {
             frame[y * LCD_WIDTH + x] = color;
         }
     }
-    y_offset -= 4 * PADDING;
-    x_offset -= (4 * PADDING + width);
-    put_char(x_offset, y_offset, frame, font, '<', GREY, MENU_BACKGROUND);
-}
-
-/**
- * checks knobs for input and convert it to menu suitable format
- *
- * @param input pointer to char which decides about conducted action
- * @param knobs_use pointer to variable which determines that knobs recorded input
- * @param knobs pointer to structure that holds information about state of knobs
- */
-void check_knobs(char *input, int *knobs_use, knobs_t *knobs) {
-    get_knob_value(knobs);
-    if (get_knob_movement(knobs, RED_K) > 1) {
-        *input = DOWN;
-        *knobs_use = 1;
-    } else if (get_knob_movement(knobs, RED_K) < -1) {
-        *input = UP;
-        *knobs_use = 1;
-    } else if (get_knob_movement(knobs, GREEN_K) > 1) {
-        *input = RIGHT;
-        *knobs_use = 1;
-    } else if (get_knob_movement(knobs, GREEN_K) < -1) {
-        *input = LEFT;
-        *knobs_use = 1;
-    } else if (get_knob_movement(knobs, RED_B) > 0 || get_knob_movement(knobs, GREEN_B) > 0) {
-        *input = ACTION;
-        *knobs_use = 1;
-    } else if (get_knob_movement(knobs, BLUE_B) > 0) {
-        *input = BACK;
-        *knobs_use = 1;
+    put_char(square.x - 4 * PADDING - width, y_offset + 2 * PADDING, frame, font, '<', GREY, MENU_BACKGROUND);
+}
+
+/**
+ * computes the area of the square of color placed by put_color_settings
+ *
+ * @param y_offset offset of the top-left corner of the menu item
+ * @param font pointer to font structure used for writing text
+ *
+ * @returns area of the square in the frame
+ */
+rect_t get_color_square(int y_offset, font_descriptor_t *font) {
+    int size = MENU_FONT_SIZE - 8 * PADDING;
+    int x_offset = LCD_WIDTH - 6 * PADDING - get_char_width(font, '>') - 4 * PADDING - size;
+    return (rect_t){x_offset, y_offset + 6 * PADDING, size, size};
+}
+
+/**
+ * the event loop of all menus, it shows the menu and handles user input until the menu is closed \n
+ * UP and DOWN scroll, LEFT and RIGHT change the setting of the selected item,
+ * ACTION opens the submenu or calls the action of the item and BACK closes the menu
+ *
+ * @param menu menu to run
+ * @param ctx structure that holds everything the menus show and change
+ *
+ * @returns MENU_CLOSE when the menu was closed \n
+ *          MENU_START or MENU_QUIT when an item closed all menus
+ */
+int run_menu(const menu_t *menu, menu_ctx_t *ctx) {
+    char log[100];
+    snprintf(log, sizeof(log), "entered %s", menu->name);
+    print_log(menu->header, log);
+    int selected = 0;
+    fill_menu(menu, selected, ctx);
+    show_menu(ctx->frame, ctx->lcd_membase);
+    snprintf(log, sizeof(log), "%s is selected", menu->items[selected].name);
+    print_log(menu->header, log);
+    int ret = MENU_STAY;
+    while (ret == MENU_STAY) {
+        /* wait for user input and then process it */
+        const menu_item_t *item = &menu->items[selected];
+        char input = wait_menu_input(NULL);
+        switch (input) {
+            case DOWN:
+                /* scroll down one item on DOWN char */
+                selected = selected < menu->count - 1 ? selected + 1 : selected;
+                snprintf(log, sizeof(log), "%s is selected", menu->items[selected].name);
+                print_log(menu->header, log);
+                break;
+            case UP:
+                /* scroll up one item on UP char */
+                selected = selected > 0 ? selected - 1 : selected;
+                snprintf(log, sizeof(log), "%s is selected", menu->items[selected].name);
+                print_log(menu->header, log);
+                break;
+            case LEFT:
+            case RIGHT:
+                /* change the setting of the selected item to its previous or next value */
+                if (item->set) {
+                    item->set(ctx, input == RIGHT ? 1 : -1);
+                    log_menu_change(menu, item, ctx);
+                }
+                break;
+            case ACTION:
+                /* open the submenu of the selected item or take its action */
+                if (item->child) {
+                    ret = run_menu(item->child, ctx);
+                    /* a closed submenu returns to this menu */
+                    if (ret == MENU_CLOSE) ret = MENU_STAY;
+                } else if (item->action) {
+                    snprintf(log, sizeof(log), "%s chosen", item->name);
+                    print_log(menu->header, log);
+                    ret = item->action(ctx, item->arg);
+                }
+                break;
+            case BACK:
+                /* exiting the menu on BACK char */
+                ret = MENU_CLOSE;
+                break;
+        }
+        if (ret == MENU_STAY) {
+            fill_menu(menu, selected, ctx);
+            show_menu(ctx->frame, ctx->lcd_membase);
+        }
+    }
+    snprintf(log, sizeof(log), "exited %s", menu->name);
+    print_log(menu->header, log);
+    return ret;
+}
+
+/**
+ * logs the new value of the setting of an item
+ *
+ * @param menu menu of the item
+ * @param item item whose setting changed
+ * @param ctx structure that holds the settings
+ */
+void log_menu_change(const menu_t *menu, const menu_item_t *item, menu_ctx_t *ctx) {
+    char log[100];
+    menu_row_t row = {item->label, UNSELECTED, item->kind, NULL, NULL, NULL, 0};
+    item->get(ctx, &row);
+    if (item->kind == ROW_COLOR) {
+        snprintf(log, sizeof(log), "%s changed to 0x%x", item->name, row.value);
+    } else if (row.value_label) {
+        snprintf(log, sizeof(log), "%s changed to %s", item->name, row.value_label);
+    } else {
+        snprintf(log, sizeof(log), "%s changed to %d", item->name, row.value);
     }
+    print_log(menu->header, log);
 }
 
 /**
- * creates and handles input of main menu \n
+ * creates and handles input of main menu and its submenus \n
  * it interprets user input and allows scrolling and starting submenu
  *
  * @param settings pointer to structure that holds settings and will be modified
@@ -236,348 +462,215 @@ void check_knobs(char *input, int *knobs_use, knobs_t *knobs) {
  *          STOP on selecting to exit the app
  */
 int main_menu(settings_t *settings, settings_fields_t *settings_fields, knobs_t *knobs, uint16_t *frame, font_descriptor_t *bigfont, font_descriptor_t *smallfont, unsigned char *lcd_membase) {
-    print_log(MAIN_MENU_HEADER, "entered main menu");
-    char *log = (char *)malloc(50 * sizeof(char));
-    int item_size = 4 * PADDING + MENU_FONT_SIZE;
-    int selected = 0;
+    menu_ctx_t ctx = {settings, settings_fields, 0, frame, lcd_membase, bigfont, smallfont, {0}};
     /* compute offsets for menu items (considering the dimensions of the items) */
-    int y_offsets[ITEMS_ON_PAGE];
-    y_offsets[0] = 0;
     for (int i = 1; i < ITEMS_ON_PAGE; i++) {
-        y_offsets[i] = y_offsets[i - 1] + item_size + SPACING;
-    }
-    char *labels[MAIN_MENU_ITEMS] = {"PLAY", "SCORES", "SETTINGS", "QUIT"};
-    /* initial fill menu with first item selected*/
-    fill_menu(y_offsets, labels, MAIN_MENU_ITEMS, selected, bigfont, frame);
-    show_frame(frame, lcd_membase);
-    if (sprintf(log, "%s is selected", labels[selected])) print_log(MAIN_MENU_HEADER, log);
-    char input;
-    int proceed = 1;
-    int ret = STOP;
-    int knobs_use = 0;
-    struct timespec loop_delay = {.tv_sec = 0, .tv_nsec = 1000 * 1000 * 10};
-    while (proceed) {
-        /* wait for user input and then process it */
-        check_knobs(&input, &knobs_use, knobs);
-        if (knobs_use || read(STDIN_FILENO, &input, 1) == 1) {
-            switch (input) {
-                case DOWN:
-                    /* scroll down when registering DOWN character on stdin */
-                    selected = selected < MAIN_MENU_ITEMS - 1 ? selected + 1 : selected;
-                    if (sprintf(log, "%s is selected", labels[selected])) print_log(MAIN_MENU_HEADER, log);
-                    fill_menu(y_offsets, labels, MAIN_MENU_ITEMS, selected, bigfont, frame);
-                    break;
-                case UP:
-                    /* scroll down when registering DOWN character on stdin */
-                    selected = selected > 0 ? selected - 1 : selected;
-                    if (sprintf(log, "%s is selected", labels[selected])) print_log(MAIN_MENU_HEADER, log);
-                    fill_menu(y_offsets, labels, MAIN_MENU_ITEMS, selected, bigfont, frame);
-                    break;
-                case ACTION:
-                    /* on pressing of ACTION button take action based on selected item */
-                    switch (selected) {
-                        case PLAY:
-                            /* show play menu, wait for start game or exit */
-                            proceed = play_menu(settings, knobs, frame, y_offsets, bigfont, lcd_membase);
-                            fill_menu(y_offsets, labels, MAIN_MENU_ITEMS, selected, bigfont, frame);
-                            /* chagne return value if game was started or was pressed back item */
-                            ret = proceed == GAME ? START : STOP;
-                            break;
-                        case HIGHSCORES:
-                            highscores_menu(settings_fields, knobs, frame, y_offsets, bigfont, lcd_membase);
-                            fill_menu(y_offsets, labels, MAIN_MENU_ITEMS, selected, bigfont, frame);
-                            break;
-                        case SETTINGS:
-                            /* show setings menu */
-                            settings_menu(settings, settings_fields, knobs, frame, y_offsets, bigfont, smallfont, lcd_membase);
-                            fill_menu(y_offsets, labels, MAIN_MENU_ITEMS, selected, bigfont, frame);
-                            break;
-                        case QUIT:
-                            print_log(MAIN_MENU_HEADER, "exited main menu");
-                            proceed = 0;
-                            ret = STOP;
-                            break;
-                    }
-                    break;
-                case BACK:
-                    /* when registered BACK character exit the menu as well */
-                    print_log(MAIN_MENU_HEADER, "exited main menu");
-                    proceed = 0;
-                    break;
-            }
-            show_frame(frame, lcd_membase);
-            knobs_use = 0;
-        }
-        clock_nanosleep(CLOCK_MONOTONIC, 0, &loop_delay, NULL); /* delay while loop */
+        ctx.y_offsets[i] = ctx.y_offsets[i - 1] + 4 * PADDING + MENU_FONT_SIZE + SPACING;
     }
-    free(log);
-    return ret;
+    start_menu_events(knobs);
+    /* the frame holds another page, the whole menu is drawn and shown */
+    clear_frame(frame);
+    reset_menu_rows();
+    int ret = run_menu(&root_menu, &ctx);
+    stop_menu_events();
+    return ret == MENU_START ? START : STOP;
 }
 
 /**
- * creates and handles input of play menu \n
- * it interprets user input and allows scrolling and selecting play mode \n
- * selected play mode is saved into settngs structure
+ * moves a color to the next or previous color of the possible settings values
  *
- * @param settings pointer to structure that holds settings and will be modified
- * @param knobs pointer to structure that holds state of knobs from last check
- * @param frame frame buffer that holds the menu items
- * @param y_offsets precomputed offsets of menu items
- * @param font pointer to font structure used for writing text
- * @param lcd_membase pointer to base memory of the lcd display
+ * @param settings_fields pointer to structure that holds possible settings values
+ * @param color current color
+ * @param step 1 for the next color, -1 for the previous one
  *
- * @returns GAME when any game mode is selected \n
- *          MENU when back item is selected
+ * @returns the new color
  */
-int play_menu(settings_t *settings, knobs_t *knobs, uint16_t *frame, int *y_offsets, font_descriptor_t *font, unsigned char *lcd_membase) {
-    print_log(PLAY_MENU_HEADER, "entered play menu");
-    char *log = (char *)malloc(50 * sizeof(char));
-    clear_frame(frame);
-    int selected = 0;
-    char *labels[PLAY_MENU_ITEMS] = {"P vs P", "P vs A", "A vs P", "BACK"};
-    /* initial show of play menu with first item selected */
-    fill_menu(y_offsets, labels, PLAY_MENU_ITEMS, selected, font, frame);
-    show_frame(frame, lcd_membase);
-    if (sprintf(log, "%s is selected", labels[selected])) print_log(PLAY_MENU_HEADER, log);
-    char input;
-    int proceed = 1;
-    int ret = MENU;
-    int knobs_use = 0;
-    struct timespec loop_delay = {.tv_sec = 0, .tv_nsec = 1000 * 1000 * 10};
-    while (proceed) {
-        /* wait for user input and then process it */
-        check_knobs(&input, &knobs_use, knobs);
-        if (knobs_use || read(STDIN_FILENO, &input, 1) == 1) {
-            switch(input) {
-                case DOWN:
-                    /* scroll down one item on DOWN char */
-                    selected = selected < PLAY_MENU_ITEMS - 1 ? selected + 1 : selected;
-                    if (sprintf(log, "%s is selected", labels[selected])) print_log(PLAY_MENU_HEADER, log);
-                    fill_menu(y_offsets, labels, PLAY_MENU_ITEMS, selected, font, frame);
-                    break;
-                case UP:
-                    /* scroll up one item on UP char*/
-                    selected = selected > 0 ? selected - 1 : selected;
-                    if (sprintf(log, "%s is selected", labels[selected])) print_log(PLAY_MENU_HEADER, log);
-                    fill_menu(y_offsets, labels, PLAY_MENU_ITEMS, selected, font, frame);
-                    break;
-                case BACK:
-                    /* exiting settings menu on BACK char in stdin */
-                    proceed = 0;
-                    break;
-                case ACTION:
-                    /* save selected mode on ACTION char and exit menu with appropriate value */
-                    switch(selected) {
-                        case PLAYER_PLAYER:
-                            settings->left = IS_PLAYER;
-                            settings->right = IS_PLAYER;
-                            print_log(PLAY_MENU_HEADER, "player-player mode");
-                            ret = GAME;
-                            break;
-                        case AI_PLAYER:
-                            settings->left = IS_AI;
-                            settings->right = IS_PLAYER;
-                            print_log(PLAY_MENU_HEADER, "ai-player mode");
-                            ret = GAME;
-                            break;
-                        case PLAYER_AI:
-                            settings->left = IS_PLAYER;
-                            settings->right = IS_AI;
-                            print_log(PLAY_MENU_HEADER, "playre-ai mode");
-                            ret = GAME;
-                            break;
-                        case PLAY_BACK:
-                            ret = MENU;
-                            break;
-                    }
-                    proceed = 0;
-                    break;
-            }
-            show_frame(frame, lcd_membase);
-            knobs_use = 0;
-        }
-        clock_nanosleep(CLOCK_MONOTONIC, 0, &loop_delay, NULL);
+uint16_t step_color(settings_fields_t *settings_fields, uint16_t color, int step) {
+    return step > 0 ? get_next_color(settings_fields, color) : get_previous_color(settings_fields, color);
+}
+
+/**
+ * puts the label of the difficulty into the row of its item
+ *
+ * @param ctx structure that holds the settings
+ * @param row row of the item, its value label is set
+ */
+void get_difficulty_setting(menu_ctx_t *ctx, menu_row_t *row) {
+    row->value_label = ctx->settings->difficulty_label;
+}
+
+/**
+ * changes the difficulty to the next or previous value and updates its label
+ *
+ * @param ctx structure that holds the settings
+ * @param step 1 for the next value, -1 for the previous one
+ */
+void set_difficulty_setting(menu_ctx_t *ctx, int step) {
+    settings_t *settings = ctx->settings;
+    if (step > 0) {
+        settings->difficulty = get_next_difficulty(ctx->settings_fields, settings->difficulty);
+    } else {
+        settings->difficulty = get_previous_difficulty(ctx->settings_fields, settings->difficulty);
     }
-    free(log);
-    print_log(PLAY_MENU_HEADER, "exited play menu");
-    return ret;
+    settings->difficulty_label = ctx->settings_fields->difficulties[settings->difficulty];
 }
 
 /**
- * creates and handles input of settings menu \n
- * it interprets user input and allows scrolling and change of settings by
- *      LEFT and RIGHT chars on stdin
+ * puts the label of the ai into the row of its item
  *
- * @param settings pointer to structure that holds settings and will be modified
- * @param settings_fields pointer to structure that holds possible settings values
- * @param knobs pointer to structure that holds state of knobs from last check
- * @param frame frame buffer that holds the menu items
- * @param y_offsets precomputed offsets of menu items
- * @param bigfont pointer to font structure used for writing big text
- * @param smallfont pointer to font structure used for writing small text
- * @param lcd_membase pointer to base memory of the lcd display
+ * @param ctx structure that holds the settings
+ * @param row row of the item, its value label is set
  */
-void settings_menu(settings_t *settings, settings_fields_t *settings_fields, knobs_t *knobs, uint16_t *frame, int *y_offsets, font_descriptor_t *bigfont, font_descriptor_t *smallfont, unsigned char *lcd_membase) {
-    print_log(SETTINGS_MENU_HEADER, "entered settings menu");
-    char *log = (char *)malloc(100 * sizeof(char));
-    clear_frame(frame);
-    int selected = 0;
-    char *labels[SETTINGS_MENU_ITEMS] = {"", "AI", "BALL", "LEFT", "RIGHT", "BACK"};
-    /* intital showing menu with first item selected */
-    fill_settings_menu(y_offsets, labels, SETTINGS_MENU_ITEMS, selected, bigfont, smallfont, frame, settings);
-    show_frame(frame, lcd_membase);
-    if (sprintf(log, "%s is selected", !(*labels[selected]) ? "difficulty" : labels[selected])) print_log(SETTINGS_MENU_HEADER, log);
-    char input;
-    struct timespec loop_delay = {.tv_sec = 0, .tv_nsec = 1000 * 1000 * 10};
-    int proceed = 1;
-    int knobs_use = 0;
-    while(proceed) {
-        /* wait for user input and process it */
-        check_knobs(&input, &knobs_use, knobs);
-        if (knobs_use || read(STDIN_FILENO, &input, 1) == 1) {
-            switch(input) {
-                case DOWN:
-                    /* scroll down one item on DOWN char */
-                    selected = selected < SETTINGS_MENU_ITEMS - 1 ? selected + 1 : selected;
-                    if (sprintf(log, "%s is selected", !(*labels[selected]) ? "difficulty" : labels[selected])) print_log(SETTINGS_MENU_HEADER, log);
-                    fill_settings_menu(y_offsets, labels, SETTINGS_MENU_ITEMS, selected, bigfont, smallfont, frame, settings);
-                    break;
-                case UP:
-                    /* scroll up one item on UP char*/
-                    selected = selected > 0 ? selected - 1 : selected;
-                    if (sprintf(log, "%s is selected", !(*labels[selected]) ? "difficulty" : labels[selected])) print_log(SETTINGS_MENU_HEADER, log);
-                    fill_settings_menu(y_offsets, labels, SETTINGS_MENU_ITEMS, selected, bigfont, smallfont, frame, settings);
-                    break;
-                case LEFT:
-                    /* change selected setting to next value (depeding on selected setting -> looking up in settings_field values */
-                    if (selected == BALL_COLOR) {
-                        settings->ballcolor = get_previous_color(settings_fields, settings->ballcolor);
-                        if (sprintf(log, "ball color changed to 0x%x", settings->ballcolor)) print_log(SETTINGS_MENU_HEADER, log);
-                    } else if (selected == LEFT_COLOR) {
-                        settings->paddlecolors[0] = get_previous_color(settings_fields, settings->paddlecolors[0]);
-                        if (sprintf(log, "left paddle color changed to 0x%x", settings->paddlecolors[0])) print_log(SETTINGS_MENU_HEADER, log);
-                    } else if (selected == RIGHT_COLOR) {
-                        settings->paddlecolors[1] = get_previous_color(settings_fields, settings->paddlecolors[1]);
-                        if (sprintf(log, "right paddle color changed to 0x%x", settings->paddlecolors[1])) print_log(SETTINGS_MENU_HEADER, log);
-                    } else if (selected == DIFFICULTY) {
-                        settings->difficulty = get_previous_difficulty(settings_fields, settings->difficulty);
-                        settings->difficulty_label = settings_fields->difficulties[settings->difficulty];
-                        if (sprintf(log, "difficulty changed to %s", settings->difficulty_label)) print_log(SETTINGS_MENU_HEADER, log);
-                    } else if (selected == SETTINGS_AI) {
-                        settings->ai = get_previous_ai(settings_fields, settings->ai);
-                        settings->ai_label = settings_fields->ai_labels[settings->ai];
-                        settings->highscore = settings_fields->highscores[settings->ai];
-                        if (sprintf(log, "ai changed to %s", settings->ai_label)) print_log(SETTINGS_MENU_HEADER, log);
-                    }
-                    fill_settings_menu(y_offsets, labels, SETTINGS_MENU_ITEMS, selected, bigfont, smallfont, frame, settings);
-                    break;
-                case RIGHT:
-                    /* change selected setting to previous value (depeding on selected setting -> looking up in settings_field values */
-                    if (selected == BALL_COLOR) {
-                        settings->ballcolor = get_next_color(settings_fields, settings->ballcolor);
-                        if (sprintf(log, "ball color changed to 0x%x", settings->ballcolor)) print_log(SETTINGS_MENU_HEADER, log);
-                    } else if (selected == LEFT_COLOR) {
-                        settings->paddlecolors[0] = get_next_color(settings_fields, settings->paddlecolors[0]);
-                        if (sprintf(log, "left paddle color changed to 0x%x", settings->paddlecolors[0])) print_log(SETTINGS_MENU_HEADER, log);
-                    } else if (selected == RIGHT_COLOR) {
-                        settings->paddlecolors[1] = get_previous_color(settings_fields, settings->paddlecolors[1]);
-                        if (sprintf(log, "right paddle color changed to 0x%x", settings->paddlecolors[1])) print_log(SETTINGS_MENU_HEADER, log);
-                    } else if (selected == DIFFICULTY) {
-                        settings->difficulty = get_next_difficulty(settings_fields, settings->difficulty);
-                        settings->difficulty_label = settings_fields->difficulties[settings->difficulty];
-                        if (sprintf(log, "difficulty changed to %s", settings->difficulty_label)) print_log(SETTINGS_MENU_HEADER, log);
-                    } else if (selected == SETTINGS_AI) {
-                        settings->ai = get_next_ai(settings_fields, settings->ai);
-                        settings->ai_label = settings_fields->ai_labels[settings->ai];
-                        settings->highscore = settings_fields->highscores[settings->ai];
-                        if (sprintf(log, "ai changed to %s", settings->ai_label)) print_log(SETTINGS_MENU_HEADER, log);
-                    }
-                    fill_settings_menu(y_offsets, labels, SETTINGS_MENU_ITEMS, selected, bigfont, smallfont, frame, settings);
-                    break;
-                case BACK:
-                    /* exiting settings menu on BACK char in stdin */
-                    proceed = 0;
-                    break;
-                case ACTION:
-                    /* if ACTION char is registered when BACK item is selected*/
-                    if (selected == SETTINGS_BACK) {
-                        proceed = 0;
-                    }
-                    break;
-            }
-            show_frame(frame, lcd_membase);
-            knobs_use = 0;
-        }
-        clock_nanosleep(CLOCK_MONOTONIC, 0, &loop_delay, NULL);
+void get_ai_setting(menu_ctx_t *ctx, menu_row_t *row) {
+    row->value_label = ctx->settings->ai_label;
+}
+
+/**
+ * changes the ai to the next or previous value and updates its label and the highscore shown in the game
+ *
+ * @param ctx structure that holds the settings
+ * @param step 1 for the next value, -1 for the previous one
+ */
+void set_ai_setting(menu_ctx_t *ctx, int step) {
+    settings_t *settings = ctx->settings;
+    if (step > 0) {
+        settings->ai = get_next_ai(ctx->settings_fields, settings->ai);
+    } else {
+        settings->ai = get_previous_ai(ctx->settings_fields, settings->ai);
     }
-    print_log(SETTINGS_MENU_HEADER, "settings menu exited");
-    free(log);
+    settings->ai_label = ctx->settings_fields->ai_labels[settings->ai];
+    settings->highscore = ctx->settings_fields->highscores[settings->ai];
 }
 
 /**
- * creates and handles input of highscores menu \n
- * it interprets user input and allows scrolling and change of settings by
- *      LEFT and RIGHT chars on stdin
+ * puts the color of the ball into the row of its item
  *
- * @param settings_fields pointer to structure that holds possible settings values
- * @param knobs pointer to structure that holds state of knobs from last check
- * @param frame frame buffer that holds the menu items
- * @param y_offsets precomputed offsets of menu items
- * @param font pointer to font structure used for writing text
- * @param lcd_membase pointer to base memory of the lcd display
+ * @param ctx structure that holds the settings
+ * @param row row of the item, its value is set
  */
-void highscores_menu(settings_fields_t *settings_fields, knobs_t *knobs, uint16_t *frame, int *y_offsets, font_descriptor_t *font, unsigned char *lcd_membase) {
-    print_log(HIGHSCORE_MENU_HEADER, "entered highscore menu");
-    int index = 0;
-    int selected = 0;
-    char *labels[HIGHSCORE_MENU_ITEMS] = {"", "", "BACK"};
-    fill_highscore_menu(y_offsets, labels, settings_fields->ai_labels[index], settings_fields->highscores[index], HIGHSCORE_MENU_ITEMS, selected, font, frame);
-    show_frame(frame, lcd_membase);
-    char input;
-    int knobs_use = 0;
-    int proceed = 1;
-    struct timespec loop_delay = {.tv_sec = 0, .tv_nsec = 1000 * 1000 * 10};
-    while (proceed) {
-        /* wait for user input and then process it */
-        check_knobs(&input, &knobs_use, knobs);
-        if (knobs_use || read(STDIN_FILENO, &input, 1) == 1) {
-            switch(input) {
-                case DOWN:
-                    /* scroll down one item on DOWN char */
-                    selected = selected < HIGHSCORE_MENU_ITEMS - 1 ? selected + 1 : selected;
-                    fill_highscore_menu(y_offsets, labels, settings_fields->ai_labels[index], settings_fields->highscores[index], HIGHSCORE_MENU_ITEMS, selected, font, frame);
-                    break;
-                case UP:
-                    /* scroll up one item on UP char*/
-                    selected = selected > 0 ? selected - 1 : selected;
-                    fill_highscore_menu(y_offsets, labels, settings_fields->ai_labels[index], settings_fields->highscores[index], HIGHSCORE_MENU_ITEMS, selected, font, frame);
-                    break;
-                case RIGHT:
-                    if (selected == HIGHSCORE_AI) {
-                        index = get_next_ai(settings_fields, index);
-                        fill_highscore_menu(y_offsets, labels, settings_fields->ai_labels[index], settings_fields->highscores[index], HIGHSCORE_MENU_ITEMS, selected, font, frame);
-                    }
-                    break;
-                case LEFT:
-                    if (selected == HIGHSCORE_AI) {
-                        index = get_previous_ai(settings_fields, index);
-                        fill_highscore_menu(y_offsets, labels, settings_fields->ai_labels[index], settings_fields->highscores[index], HIGHSCORE_MENU_ITEMS, selected, font, frame);
-                    }
-                    break;
-                case ACTION:
-                    if (selected == HIGHSCORE_BACK) {
-                        proceed = 0;
-                    }
-                    break;
-                case BACK:
-                    /* exiting settings menu on BACK char in stdin */
-                    proceed = 0;
-                    break;
-            }
-            show_frame(frame, lcd_membase);
-            knobs_use = 0;
-        }
-        clock_nanosleep(CLOCK_MONOTONIC, 0, &loop_delay, NULL);
+void get_ball_color(menu_ctx_t *ctx, menu_row_t *row) {
+    row->value = ctx->settings->ballcolor;
+}
+
+/**
+ * changes the color of the ball to the next or previous value
+ *
+ * @param ctx structure that holds the settings
+ * @param step 1 for the next value, -1 for the previous one
+ */
+void set_ball_color(menu_ctx_t *ctx, int step) {
+    ctx->settings->ballcolor = step_color(ctx->settings_fields, ctx->settings->ballcolor, step);
+}
+
+/**
+ * puts the color of the left paddle into the row of its item
+ *
+ * @param ctx structure that holds the settings
+ * @param row row of the item, its value is set
+ */
+void get_left_color(menu_ctx_t *ctx, menu_row_t *row) {
+    row->value = ctx->settings->paddlecolors[0];
+}
+
+/**
+ * changes the color of the left paddle to the next or previous value
+ *
+ * @param ctx structure that holds the settings
+ * @param step 1 for the next value, -1 for the previous one
+ */
+void set_left_color(menu_ctx_t *ctx, int step) {
+    ctx->settings->paddlecolors[0] = step_color(ctx->settings_fields, ctx->settings->paddlecolors[0], step);
+}
+
+/**
+ * puts the color of the right paddle into the row of its item
+ *
+ * @param ctx structure that holds the settings
+ * @param row row of the item, its value is set
+ */
+void get_right_color(menu_ctx_t *ctx, menu_row_t *row) {
+    row->value = ctx->settings->paddlecolors[1];
+}
+
+/**
+ * changes the color of the right paddle to the next or previous value
+ *
+ * @param ctx structure that holds the settings
+ * @param step 1 for the next value, -1 for the previous one
+ */
+void set_right_color(menu_ctx_t *ctx, int step) {
+    ctx->settings->paddlecolors[1] = step_color(ctx->settings_fields, ctx->settings->paddlecolors[1], step);
+}
+
+/**
+ * puts the label of the ai whose highscore is shown into the row of its item
+ *
+ * @param ctx structure that holds the settings
+ * @param row row of the item, its value label is set
+ */
+void get_highscore_ai(menu_ctx_t *ctx, menu_row_t *row) {
+    row->value_label = ctx->settings_fields->ai_labels[ctx->highscore_ai];
+}
+
+/**
+ * changes the ai whose highscore is shown to the next or previous value
+ *
+ * @param ctx structure that holds the settings
+ * @param step 1 for the next value, -1 for the previous one
+ */
+void set_highscore_ai(menu_ctx_t *ctx, int step) {
+    if (step > 0) {
+        ctx->highscore_ai = get_next_ai(ctx->settings_fields, ctx->highscore_ai);
+    } else {
+        ctx->highscore_ai = get_previous_ai(ctx->settings_fields, ctx->highscore_ai);
     }
-    print_log(HIGHSCORE_MENU_HEADER, "highscore menu exited");
+}
+
+/**
+ * puts the highscore of the ai shown in the highscore menu into the row of its item
+ *
+ * @param ctx structure that holds the settings
+ * @param row row of the item, its value is set
+ */
+void get_highscore(menu_ctx_t *ctx, menu_row_t *row) {
+    row->value = ctx->settings_fields->highscores[ctx->highscore_ai];
+}
+
+/**
+ * saves the game mode of the play menu into settings and closes all menus to start the game
+ *
+ * @param ctx structure that holds the settings
+ * @param mode index of the item of the game mode in the play menu
+ *
+ * @returns MENU_START
+ */
+int choose_game_mode(menu_ctx_t *ctx, int mode) {
+    ctx->settings->left = game_modes[mode][0];
+    ctx->settings->right = game_modes[mode][1];
+    ctx->settings->ball_count = game_modes[mode][2];
+    return MENU_START;
+}
+
+/**
+ * closes the menu of the item
+ *
+ * @param ctx unused
+ * @param arg unused
+ *
+ * @returns MENU_CLOSE
+ */
+int close_menu(menu_ctx_t *ctx, int arg) {
+    return MENU_CLOSE;
+}
+
+/**
+ * closes all menus to exit the app
+ *
+ * @param ctx unused
+ * @param arg unused
+ *
+ * @returns MENU_QUIT
+ */
+int quit_menus(menu_ctx_t *ctx, int arg) {
+    return MENU_QUIT;
 }
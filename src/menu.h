@@ -1,6 +1,8 @@
 /** @file
  * Module with functions to create, modify and control menu in this application \n
- * It modifies settings structure according to selections in the menu
+ * It modifies settings structure according to selections in the menu \n
+ * The menus are a static tree of item descriptors run by one event loop (run_menu), drawn by one renderer
+ * which redraws only the changed rows from cached bitmaps and shown by one presenter which sends only those rows.
  */
 
 #ifndef MENU_H
@@ -18,6 +20,7 @@
 #include "mzapo_parlcd.h"
 #include "peripherals.h"
 
+#define MENU_HEADER "MENU: "
 #define MAIN_MENU_HEADER "MAIN MENU: "
 #define SETTINGS_MENU_HEADER "SETTINGS MENU: "
 #define PLAY_MENU_HEADER "PLAY MENU: "
@@ -42,7 +45,7 @@
 /* constants that hold number of items in menu and submenus */
 #define MAIN_MENU_ITEMS 4
 #define SETTINGS_MENU_ITEMS 6
-#define PLAY_MENU_ITEMS 4
+#define PLAY_MENU_ITEMS 5
 #define HIGHSCORE_MENU_ITEMS 3
 
 /* indexes of items in main menu */
@@ -55,7 +58,8 @@
 #define PLAYER_PLAYER 0
 #define PLAYER_AI 1
 #define AI_PLAYER 2
-#define PLAY_BACK 3
+#define PLAY_MULTI_BALL 3
+#define PLAY_BACK 4
 
 /* settings values for players set according to choices above */
 #define IS_PLAYER 1
@@ -69,12 +73,6 @@
 #define RIGHT_COLOR 4
 #define SETTINGS_BACK 5
 
-/* values that are returned from play submenu
- * (games starts / goes back to main menu) 
- */
-#define GAME 0
-#define MENU 1
-
 /* indexes of highscore options */
 #define HIGHSCORE_AI 0
 #define HIGHSCORE_NUMBER 1
@@ -92,6 +90,113 @@
 #define NOT_CENTER 0
 #define CENTER 1
 
+/* kinds of setting shown in a row of menu, ROW_BLANK is a row without item */
+#define ROW_BLANK 0
+#define ROW_PLAIN 1
+#define ROW_LABEL 2
+#define ROW_SMALL_LABEL 3
+#define ROW_COLOR 4
+#define ROW_NUMBER 5
+
+/* height of the area drawn by put_menu_element */
+#define MENU_ROW_HEIGHT (3 * PADDING + MENU_FONT_SIZE)
+
+/* number of drawn rows kept as bitmaps by the renderer */
+#define MENU_BITMAP_COUNT 16
+
+/* results of an item action and of run_menu */
+#define MENU_STAY 0
+#define MENU_CLOSE 1
+#define MENU_START 2
+#define MENU_QUIT 3
+
+/**
+ * structure that describes what one row of the menu shows \n
+ * rows are redrawn only when it changes
+ */
+typedef struct menu_row {
+    /** label of the item, NULL for a row that is not known to be drawn */
+    char *label;
+    /** color of the item (SELECTED or UNSELECTED) */
+    uint16_t color;
+    /** kind of setting shown in the item, one of ROW_ constants */
+    int kind;
+    /** font of the label */
+    font_descriptor_t *font;
+    /** font of the setting */
+    font_descriptor_t *value_font;
+    /** label of the setting for ROW_LABEL and ROW_SMALL_LABEL */
+    char *value_label;
+    /** color of the setting for ROW_COLOR, number for ROW_NUMBER */
+    int value;
+} menu_row_t;
+
+/**
+ * structure that holds everything the menus show and change
+ */
+typedef struct menu_ctx {
+    /** settings that are modified by the menus */
+    settings_t *settings;
+    /** possible settings values */
+    settings_fields_t *settings_fields;
+    /** index of the ai whose highscore is shown in the highscore menu */
+    int highscore_ai;
+    /** frame buffer that holds the menu items */
+    uint16_t *frame;
+    /** pointer to base memory of the lcd display */
+    unsigned char *lcd_membase;
+    /** font of the labels and settings */
+    font_descriptor_t *bigfont;
+    /** font of the settings of ROW_SMALL_LABEL items */
+    font_descriptor_t *smallfont;
+    /** offsets of top-left corners of the rows on screen */
+    int y_offsets[ITEMS_ON_PAGE];
+} menu_ctx_t;
+
+struct menu;
+
+/**
+ * structure that describes one item of a menu
+ */
+typedef struct menu_item {
+    /** label written in the item, empty when the setting takes its place */
+    char *label;
+    /** name of the item in the log */
+    char *name;
+    /** kind of setting shown in the item, one of ROW_ constants */
+    int kind;
+    /** fills value_label or value of the row with the setting shown in the item, NULL for ROW_PLAIN */
+    void (*get)(menu_ctx_t *ctx, menu_row_t *row);
+    /** changes the setting by one step forward (1) or back (-1) on RIGHT and LEFT, NULL if it cannot be changed */
+    void (*set)(menu_ctx_t *ctx, int step);
+    /** submenu opened on ACTION, NULL for none */
+    const struct menu *child;
+    /** called on ACTION when there is no submenu, returns one of MENU_ results, NULL for no action */
+    int (*action)(menu_ctx_t *ctx, int arg);
+    /** argument of the action */
+    int arg;
+} menu_item_t;
+
+/**
+ * structure that describes one menu of the tree
+ */
+typedef struct menu {
+    /** name of the menu in the log */
+    char *name;
+    /** header of the log messages of the menu */
+    char *header;
+    /** number of items */
+    int count;
+    /** items of the menu from top to bottom */
+    const menu_item_t *items;
+} menu_t;
+
+/* the menus of the application, root_menu is the main menu */
+extern const menu_t root_menu;
+extern const menu_t play_menu;
+extern const menu_t settings_menu;
+extern const menu_t highscore_menu;
+
 /**
  * puts new item of same format into frame buffer
  *
@@ -105,48 +210,49 @@
 void put_menu_element(int y, char *label, uint16_t *frame, font_descriptor_t *font, uint16_t color);
 
 /**
- * fills whole screen with number of items (other will not fit) preset in ITEMS_ON_PAGE \n
- * it considers which item is currently selected and tries to place it in the middle of the screen (except first one) \n
- * it is not meant for settings menu
+ * forgets what the rows of the menu show, so the next fill draws all of them \n
+ * it is called when a menu is entered after the frame was cleared, the whole frame is shown then
+ */
+void reset_menu_rows(void);
+
+/**
+ * draws one row of the menu into frame buffer unless it shows the same already \n
+ * the redrawn part is added to the damage of the menu, only the square changes when just the color of a color item changed
  *
- * @param y_offsets precomputed array of top-left corners of all items (3) on screen
- * @param labels list of strings (double char pointer) that are to be placed into menu items
- * @param count total number of items in the menu (not the number of visible ones)
- * @param selected index of the item that is currently selected
- * @param font pointer to font structure used for writing text
+ * @param index index of the row on the screen
+ * @param y vertical offset of top-left corner of the row
+ * @param row what the row is to show
  * @param frame frame buffer that holds the menu items
  */
-void fill_menu(int *y_offsets, char **labels, int count, int selected, font_descriptor_t *font, uint16_t *frame);
+void update_menu_row(int index, int y, menu_row_t *row, uint16_t *frame);
 
 /**
- * fills whole screen with number of items preset in ITEMS_ON_PAGE \n
- * items contain different interactive aspect (colro square or different kind of label)
+ * clears the rows of the screen below the last item of the menu
  *
+ * @param index index of the first row on the screen without item
  * @param y_offsets precomputed array of top-left corners of all items (3) on screen
- * @param labels list of strings (double char pointer) that are to be placed into menu items
- * @param count total number of items in the menu (not the number of visible ones)
- * @param selected index of the item that is currently selected
- * @param bigfont pointer to font structure used for writing big text
- * @param smallfont pointer to font structure used for writing small text
  * @param frame frame buffer that holds the menu items
- * @param settings pointer to structure that hold current settings and is both read and modified
  */
-void fill_settings_menu(int *y_offsets, char **labels, int count, int selected, font_descriptor_t *bigfont, font_descriptor_t *smallfont, uint16_t *frame, settings_t *settings);
+void clear_menu_rows(int index, int *y_offsets, uint16_t *frame);
 
 /**
- * fills whole scrren with number of items preset in ITEMS_ON_PAGE \n
- * items contain different or none interactive aspects
+ * shows the rows of the menu which changed since they were last shown on the lcd display
  *
- * @param y_offsets precomputed array of top-left corners of all items (3) on screen
- * @param labels list of strings (double char pointer) that are to be placed into menu items
- * @param ai_label label of ai for which is displayed highscore
- * @param highscore number that represents highscore of selected ai (same as ai_label)
- * @param count total number of items in the menu (not the number of visible ones)
- * @param selected index of the item that is currently selected
- * @param font pointer to font structure used for writing text
  * @param frame frame buffer that holds the menu items
+ * @param lcd_membase pointer to base memory of the lcd display
  */
-void fill_highscore_menu(int *y_offsets, char **labels, char *ai_label, int highscore, int count, int selected, font_descriptor_t *font, uint16_t *frame);
+void show_menu(uint16_t *frame, unsigned char *lcd_membase);
+
+/**
+ * fills whole screen with number of items (other will not fit) preset in ITEMS_ON_PAGE \n
+ * it considers which item is currently selected and tries to place it in the middle of the screen (except first one) \n
+ * only the rows that changed are drawn, see update_menu_row
+ *
+ * @param menu menu to fill the screen with
+ * @param selected index of the item that is currently selected
+ * @param ctx structure that holds the settings shown in the items and the frame
+ */
+void fill_menu(const menu_t *menu, int selected, menu_ctx_t *ctx);
 
 /**
  * puts currently selected label setting item into itme \n
@@ -172,76 +278,48 @@ void put_label_settings(int y_offset, char *label, font_descriptor_t *font, uint
 void put_color_settings(int y_offset, uint16_t color, font_descriptor_t *font, uint16_t *frame);
 
 /**
- * checks knobs for input and convert it to menu suitable format
- *
- * @param input pointer to char which decides about conducted action
- * @param knobs_use pointer to variable which determines that knobs recorded input
- * @param knobs pointer to structure that holds information about state of knobs
- */
-void check_knobs(char *input, int *knobs_use, knobs_t *knobs);
-
-/**
- * creates and handles input of main menu \n
- * it interprets user input and allows scrolling and starting submenu
+ * computes the area of the square of color placed by put_color_settings
  *
- * @param settings pointer to structure that holds settings and will be modified
- * @param settings_fields pointer to structure that holds possible settings values
- * @param knobs pointer to structure that holds state of knobs from last check
- * @param frame frame buffer that holds the menu items
- * @param bigfont pointer to font structure used for writing big text
- * @param smallfont pointer to font structure used for writing small text
- * @param lcd_membase pointer to base memory of the lcd display
+ * @param y_offset offset of the top-left corner of the menu item
+ * @param font pointer to font structure used for writing text
  *
- * @returns START on selecting to play a game \n
- *          STOP on selecting to exit the app
+ * @returns area of the square in the frame
  */
-int main_menu(settings_t *settings, settings_fields_t *settings_fields, knobs_t *knobs, uint16_t *frame, font_descriptor_t *bigfont, font_descriptor_t *smallfont, unsigned char *lcd_membase);
+rect_t get_color_square(int y_offset, font_descriptor_t *font);
 
 /**
- * creates and handles input of play menu \n
- * it interprets user input and allows scrolling and selecting play mode \n
- * selected play mode is saved into settngs structure
+ * the event loop of all menus, it shows the menu and handles user input until the menu is closed \n
+ * UP and DOWN scroll, LEFT and RIGHT change the setting of the selected item,
+ * ACTION opens the submenu or calls the action of the item and BACK closes the menu
  *
- * @param settings pointer to structure that holds settings and will be modified
- * @param knobs pointer to structure that holds state of knobs from last check
- * @param frame frame buffer that holds the menu items
- * @param y_offsets precomputed offsets of menu items
- * @param font pointer to font structure used for writing text
- * @param lcd_membase pointer to base memory of the lcd display
+ * @param menu menu to run
+ * @param ctx structure that holds everything the menus show and change
  *
- * @returns GAME when any game mode is selected \n
- *          MENU when back item is selected
+ * @returns MENU_CLOSE when the menu was closed \n
+ *          MENU_START or MENU_QUIT when an item closed all menus
  */
-int play_menu(settings_t *settings, knobs_t *knobs, uint16_t *frame, int *y_offsets, font_descriptor_t *font, unsigned char *lcd_membase);
+int run_menu(const menu_t *menu, menu_ctx_t *ctx);
 
 /**
- * creates and handles input of settings menu \n
- * it interprets user input and allows scrolling and change of settings by
- *      LEFT and RIGHT chars on stdin
+ * creates and handles input of main menu and its submenus \n
+ * it interprets user input and allows scrolling and starting submenu
  *
  * @param settings pointer to structure that holds settings and will be modified
  * @param settings_fields pointer to structure that holds possible settings values
  * @param knobs pointer to structure that holds state of knobs from last check
  * @param frame frame buffer that holds the menu items
- * @param y_offsets precomputed offsets of menu items
  * @param bigfont pointer to font structure used for writing big text
  * @param smallfont pointer to font structure used for writing small text
  * @param lcd_membase pointer to base memory of the lcd display
+ *
+ * @returns START on selecting to play a game \n
+ *          STOP on selecting to exit the app
  */
-void settings_menu(settings_t *settings, settings_fields_t *settings_fields, knobs_t *knobs, uint16_t *frame, int *y_offsets, font_descriptor_t *bigfont, font_descriptor_t *smallfont, unsigned char *lcd_membase);
+int main_menu(settings_t *settings, settings_fields_t *settings_fields, knobs_t *knobs, uint16_t *frame, font_descriptor_t *bigfont, font_descriptor_t *smallfont, unsigned char *lcd_membase);
 
 /**
- * creates and handles input of highscores menu \n
- * it interprets user input and allows scrolling and change of settings by
- *      LEFT and RIGHT chars on stdin
- *
- * @param settings_fields pointer to structure that holds possible settings values
- * @param knobs pointer to structure that holds state of knobs from last check
- * @param frame frame buffer that holds the menu items
- * @param y_offsets precomputed offsets of menu items
- * @param font pointer to font structure used for writing text
- * @param lcd_membase pointer to base memory of the lcd display
+ * frees the bitmaps of the rows kept by the renderer
  */
-void highscores_menu(settings_fields_t *settings_fields, knobs_t *knobs, uint16_t *frame, int *y_offsets, font_descriptor_t *font, unsigned char *lcd_membase);
+void destroy_menu_bitmaps(void);
 
 #endif
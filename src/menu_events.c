@@ -0,0 +1,268 @@
+/** @file
+ * Module with the event loop shared by all menus \n
+ * The menus wait in poll() for stdin and for the pipe of the knob watcher thread
+ */
+
+#define _GNU_SOURCE
+
+#include "menu_events.h"
+#include "menu.h"
+#include "graphics.h"
+#include "tick_scheduler.h"
+#include "log.h"
+#include <pthread.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/**
+ * one menu input found by the knob watcher, written into the pipe as a whole
+ */
+struct knob_event {
+    /** the menu control char */
+    char input;
+    /** the time of the monotonic clock in nanoseconds when the change of the knobs was sampled */
+    long long seen_ns;
+};
+
+void *watch_knobs(void *arg);
+int knobs_changed(knobs_t *knobs);
+void close_menu_pipes(void);
+
+/* number of nested start_menu_events calls */
+static int users = 0;
+/* knobs of the menus, read directly only when the watcher does not run */
+static knobs_t *menu_knobs = NULL;
+/* own state of the knobs of the watcher thread */
+static knobs_t *watched_knobs = NULL;
+static int event_pipe[2] = {-1, -1};
+static int stop_pipe[2] = {-1, -1};
+static pthread_t watcher;
+static char watcher_running = 0;
+/* cleared once stdin reaches its end, the menus are then controlled by the knobs only */
+static char stdin_open = 1;
+/* time of the last input in nanoseconds, 0 once its redraw is shown */
+static long long input_ns = 0;
+
+/**
+ * checks knobs for input and convert it to menu suitable format
+ *
+ * @param input pointer to char which decides about conducted action
+ * @param knobs_use pointer to variable which determines that knobs recorded input
+ * @param knobs pointer to structure that holds information about state of knobs
+ */
+void check_knobs(char *input, int *knobs_use, knobs_t *knobs) {
+    get_knob_value(knobs);
+    if (get_knob_movement(knobs, RED_K) > 1) {
+        *input = DOWN;
+        *knobs_use = 1;
+    } else if (get_knob_movement(knobs, RED_K) < -1) {
+        *input = UP;
+        *knobs_use = 1;
+    } else if (get_knob_movement(knobs, GREEN_K) > 1) {
+        *input = RIGHT;
+        *knobs_use = 1;
+    } else if (get_knob_movement(knobs, GREEN_K) < -1) {
+        *input = LEFT;
+        *knobs_use = 1;
+    } else if (get_knob_movement(knobs, RED_B) > 0 || get_knob_movement(knobs, GREEN_B) > 0) {
+        *input = ACTION;
+        *knobs_use = 1;
+    } else if (get_knob_movement(knobs, BLUE_B) > 0) {
+        *input = BACK;
+        *knobs_use = 1;
+    }
+}
+
+/**
+ * starts the menu events, the knob watcher runs until the matching stop_menu_events \n
+ * the calls can be nested, e.g. a submenu inside a menu, only the outermost pair starts and stops the watcher \n
+ * if the watcher cannot be started, wait_menu_input checks the knobs itself every MENU_KNOB_ACTIVE_MS
+ *
+ * @param knobs pointer to structure that holds state of knobs, only its base memory is used
+ */
+void start_menu_events(knobs_t *knobs) {
+    if (users++) return;
+    menu_knobs = knobs;
+    input_ns = 0;
+    watched_knobs = init_knobs(knobs->membase);
+    if (pipe2(event_pipe, O_NONBLOCK | O_CLOEXEC) || pipe2(stop_pipe, O_CLOEXEC)) {
+        if (LOG_MENU_EVENTS) print_log(MENU_EVENTS_HEADER, "ERROR: pipes not created, knobs are checked on a timer");
+        close_menu_pipes();
+        return;
+    }
+    if (pthread_create(&watcher, NULL, watch_knobs, NULL)) {
+        if (LOG_MENU_EVENTS) print_log(MENU_EVENTS_HEADER, "ERROR: knob watcher not created, knobs are checked on a timer");
+        close_menu_pipes();
+        return;
+    }
+    watcher_running = 1;
+}
+
+/**
+ * stops the menu events started by start_menu_events, knob inputs not taken yet are dropped
+ */
+void stop_menu_events(void) {
+    if (!users || --users) return;
+    if (watcher_running) {
+        char stop = 0;
+        if (write(stop_pipe[1], &stop, 1) != 1) pthread_cancel(watcher);
+        pthread_join(watcher, NULL);
+        watcher_running = 0;
+    }
+    close_menu_pipes();
+    destroy_knobs(watched_knobs);
+    watched_knobs = NULL;
+    /* the knobs turned in the menus are not a movement for whoever reads them next */
+    get_knob_value(menu_knobs);
+    get_knob_value(menu_knobs);
+}
+
+/**
+ * closes the pipes of the menu events which are open
+ */
+void close_menu_pipes(void) {
+    for (int i = 0; i < 2; i++) {
+        if (event_pipe[i] >= 0) close(event_pipe[i]);
+        if (stop_pipe[i] >= 0) close(stop_pipe[i]);
+        event_pipe[i] = -1;
+        stop_pipe[i] = -1;
+    }
+}
+
+/**
+ * blocks until the next menu input comes from stdin or from the knobs
+ *
+ * @param from_knobs if not NULL it is set to 1 for an input from the knobs and to 0 for a key on stdin
+ *
+ * @returns the menu control char (DOWN, UP, LEFT, RIGHT, ACTION, BACK) or any other key from stdin
+ */
+char wait_menu_input(char *from_knobs) {
+    struct pollfd fds[2];
+    while (1) {
+        int count = 0;
+        int knob_fd = -1;
+        if (stdin_open) fds[count++] = (struct pollfd){STDIN_FILENO, POLLIN, 0};
+        if (watcher_running) {
+            knob_fd = count;
+            fds[count++] = (struct pollfd){event_pipe[0], POLLIN, 0};
+        }
+        /* without the watcher the knobs are checked after every timeout like the menus used to */
+        if (poll(fds, count, watcher_running ? -1 : MENU_KNOB_ACTIVE_MS) < 0) {
+            if (errno != EINTR) poll(NULL, 0, MENU_KNOB_ACTIVE_MS);
+            continue;
+        }
+        char input;
+        if (knob_fd >= 0 && fds[knob_fd].revents) {
+            struct knob_event event;
+            if (read(event_pipe[0], &event, sizeof(event)) == sizeof(event)) {
+                input_ns = event.seen_ns;
+                if (from_knobs) *from_knobs = 1;
+                return event.input;
+            }
+        } else if (!watcher_running && menu_knobs) {
+            int knobs_use = 0;
+            check_knobs(&input, &knobs_use, menu_knobs);
+            if (knobs_use) {
+                input_ns = monotonic_ns();
+                if (from_knobs) *from_knobs = 1;
+                return input;
+            }
+        }
+        if (stdin_open && fds[0].revents) {
+            ssize_t got = read(STDIN_FILENO, &input, 1);
+            if (got == 1) {
+                input_ns = monotonic_ns();
+                if (from_knobs) *from_knobs = 0;
+                return input;
+            }
+            if (got == 0 || (errno != EAGAIN && errno != EINTR)) {
+                stdin_open = 0;
+                if (LOG_MENU_EVENTS) print_log(MENU_EVENTS_HEADER, "stdin closed, menus are controlled by knobs only");
+            }
+        }
+    }
+}
+
+/**
+ * shows the changed areas of the frame on the lcd display and logs it if the redraw missed MENU_REDRAW_TARGET_MS after the last input
+ *
+ * @param frame frame buffer that holds the menu
+ * @param lcd_membase pointer to base memory of the lcd display
+ * @param damage areas of the frame changed since it was last shown, they are forgotten
+ */
+void show_menu_frame(uint16_t *frame, unsigned char *lcd_membase, damage_t *damage) {
+    show_damage(frame, lcd_membase, damage);
+    if (!input_ns) return;
+    long long latency = (monotonic_ns() - input_ns) / NSEC_PER_MSEC;
+    input_ns = 0;
+    if (latency > MENU_REDRAW_TARGET_MS && LOG_MENU_EVENTS) {
+        char log[80];
+        sprintf(log, "redraw %lld ms after the input, the target is %d ms", latency, MENU_REDRAW_TARGET_MS);
+        print_log(MENU_EVENTS_HEADER, log);
+    }
+}
+
+/**
+ * adds end message to frame, displays it and waits for any key press
+ *
+ * @param frame pointer to frame buffer to put result page pixels in
+ * @param lcd_membase base memory to mapped lcd display
+ * @param knobs structure that enables getting input from knobs on the board
+ */
+void show_and_wait(uint16_t *frame, unsigned char *lcd_membase, knobs_t *knobs) {
+    put_string((LCD_WIDTH - get_string_width(&font_wArial_44, END_MESSAGE)) / 2, SHOW_AND_WAIT_Y_OFFSET, frame, &font_wArial_44, END_MESSAGE, GREY, BACKGROUND);
+    show_frame(frame, lcd_membase);
+    start_menu_events(knobs);
+    char from_knobs;
+    char c;
+    /* any key ends the wait, of the knobs only the buttons do */
+    do {
+        c = wait_menu_input(&from_knobs);
+    } while (from_knobs && c != ACTION && c != BACK);
+    stop_menu_events();
+}
+
+/**
+ * body of the knob watcher thread \n
+ * it samples the knobs until a byte comes into the stop pipe and writes every menu input they make into the event pipe
+ *
+ * @param arg unused
+ */
+void *watch_knobs(void *arg) {
+    (void)arg;
+    long long last_change = monotonic_ns();
+    struct pollfd stop = {stop_pipe[0], POLLIN, 0};
+    while (1) {
+        long long now = monotonic_ns();
+        int period = now - last_change < MENU_KNOB_IDLE_AFTER_MS * NSEC_PER_MSEC ? MENU_KNOB_ACTIVE_MS : MENU_KNOB_IDLE_MS;
+        int ready = poll(&stop, 1, period);
+        if (ready > 0 || (ready < 0 && errno != EINTR)) break;
+        struct knob_event event;
+        int knobs_use = 0;
+        check_knobs(&event.input, &knobs_use, watched_knobs);
+        if (!knobs_changed(watched_knobs)) continue;
+        last_change = monotonic_ns();
+        if (!knobs_use) continue;
+        event.seen_ns = last_change;
+        /* the pipe fills up only when nobody takes the inputs, they are dropped then */
+        if (write(event_pipe[1], &event, sizeof(event)) != sizeof(event) && LOG_MENU_EVENTS) {
+            print_log(MENU_EVENTS_HEADER, "knob input dropped");
+        }
+    }
+    return NULL;
+}
+
+/**
+ * checks if any knob or button changed between the last two samples, even by less than a menu step
+ *
+ * @param knobs structure that holds the last two samples of the knobs
+ *
+ * @returns 1 if anything changed, 0 otherwise
+ */
+int knobs_changed(knobs_t *knobs) {
+    for (int i = 0; i < KNOB_COUNT; i++) {
+        if (knobs->before[i] != knobs->now[i]) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/** @file
+ * Module with the event loop shared by all menus \n
+ * The menus block in poll() until a key comes on stdin or a knob changes, so nothing runs while nobody touches the board. \n
+ * The knob register cannot wake anybody up, so a watcher thread samples it and writes the menu controls into a pipe
+ * only when a knob turns by more than one step or a button is pushed. The watcher samples every MENU_KNOB_ACTIVE_MS
+ * while the knobs move and every MENU_KNOB_IDLE_MS once they have been still for MENU_KNOB_IDLE_AFTER_MS. \n
+ * Latency targets from the input to the end of the redraw:
+ * - a key on stdin: MENU_REDRAW_TARGET_MS
+ * - a knob: MENU_KNOB_IDLE_MS + MENU_REDRAW_TARGET_MS for the first step after the knobs were still,
+ *   MENU_KNOB_ACTIVE_MS + MENU_REDRAW_TARGET_MS while they turn
+ *
+ * The redraw is measured from the moment the input is seen, slower redraws are logged. \n
+ * The wait for a key after a game (show_and_wait) uses the same events, so the lcd module does not depend on the menus.
+ */
+
+#ifndef MENU_EVENTS_H
+#define MENU_EVENTS_H
+
+#include <stdint.h>
+#include "peripherals.h"
+#include "graphics.h"
+
+#define MENU_EVENTS_HEADER "MENU EVENTS: "
+#define LOG_MENU_EVENTS 1
+
+/* sampling periods of the knob watcher */
+#define MENU_KNOB_ACTIVE_MS 10
+#define MENU_KNOB_IDLE_MS 50
+#define MENU_KNOB_IDLE_AFTER_MS 1000
+
+/* the longest time from seeing the input to the end of the redraw of the menu */
+#define MENU_REDRAW_TARGET_MS 40
+
+/**
+ * checks knobs for input and convert it to menu suitable format
+ *
+ * @param input pointer to char which decides about conducted action
+ * @param knobs_use pointer to variable which determines that knobs recorded input
+ * @param knobs pointer to structure that holds information about state of knobs
+ */
+void check_knobs(char *input, int *knobs_use, knobs_t *knobs);
+
+/**
+ * starts the menu events, the knob watcher runs until the matching stop_menu_events \n
+ * the calls can be nested, e.g. a submenu inside a menu, only the outermost pair starts and stops the watcher \n
+ * if the watcher cannot be started, wait_menu_input checks the knobs itself every MENU_KNOB_ACTIVE_MS
+ *
+ * @param knobs pointer to structure that holds state of knobs, only its base memory is used
+ */
+void start_menu_events(knobs_t *knobs);
+
+/**
+ * stops the menu events started by start_menu_events, knob inputs not taken yet are dropped
+ */
+void stop_menu_events(void);
+
+/**
+ * blocks until the next menu input comes from stdin or from the knobs
+ *
+ * @param from_knobs if not NULL it is set to 1 for an input from the knobs and to 0 for a key on stdin
+ *
+ * @returns the menu control char (DOWN, UP, LEFT, RIGHT, ACTION, BACK) or any other key from stdin
+ */
+char wait_menu_input(char *from_knobs);
+
+/**
+ * shows the changed areas of the frame on the lcd display and logs it if the redraw missed MENU_REDRAW_TARGET_MS after the last input
+ *
+ * @param frame frame buffer that holds the menu
+ * @param lcd_membase pointer to base memory of the lcd display
+ * @param damage areas of the frame changed since it was last shown, they are forgotten
+ */
+void show_menu_frame(uint16_t *frame, unsigned char *lcd_membase, damage_t *damage);
+
+/**
+ * adds end message to frame, displays it and waits for any key press
+ *
+ * @param frame pointer to frame buffer to put result page pixels in
+ * @param lcd_membase base memory to mapped lcd display
+ * @param knobs structure that enables getting input from knobs on the board
+ */
+void show_and_wait(uint16_t *frame, unsigned char *lcd_membase, knobs_t *knobs);
+
+#endif
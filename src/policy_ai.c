@@ -0,0 +1,172 @@
+/** @file
+*/
+
+#define _DEFAULT_SOURCE
+
+#include "policy_ai.h"
+#include "basic_ai.h"
+#include "log.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+int policy_bin(int value, int span, int bins);
+
+const ai_interface_t policy_ai = {"LEARN", 0, NULL, policy_ai_move, NULL, NULL};
+
+// the mapped policy file, NULL if no policy is loaded
+static unsigned char* policy = NULL;
+// the checksum of the moves of the loaded policy, 0 if no policy is loaded
+static uint32_t policy_sum = 0;
+
+/**
+ * This funciton is called every game update to determine the AI's movement. \n
+ * It is the move function of the AI, see ai_interface.h.
+ * @param is_right 0 if the AI controls the left paddle, \n
+ *                 1 if the AI controls the right paddle
+ * @param game_data a structure containing all information about the state of the game
+ * @param state the state the AI keeps between updates for this paddle
+ * @param seed the state of the random numbers of the game, to be used with rand_r
+ * @return -1 for moving up \n
+ *          0 for not moving \n
+ *          1 for moving down
+ * @see game.h for struct game_data and struct ai_state
+ */
+char policy_ai_move(char is_right, struct game_data game_data, struct ai_state* state, unsigned int* seed) {
+    if (!policy) return basic_ai_move(is_right, game_data, state, seed);
+    return (signed char)policy[POLICY_HEADER_SIZE + policy_index(is_right, &game_data)];
+}
+
+/**
+ * Get the index of the state of the game in the policy table.
+ * @param is_right 0 for the left paddle, 1 for the right one
+ * @param game_data the state of the game
+ * @return the index of the state, from 0 to POLICY_STATES - 1
+ */
+int policy_index(char is_right, struct game_data* game_data) {
+    const int face = is_right ? LCD_WIDTH - PADDLE_WIDTH - BALL_SIZE : PADDLE_WIDTH;
+    int ball_x = FIXED_TO_INT(game_data->ball_pos_x);
+    int x = policy_bin(is_right ? face - ball_x : ball_x - face, LCD_WIDTH - 2 * PADDLE_WIDTH - BALL_SIZE + 1, POLICY_X_BINS);
+    int y = policy_bin(FIXED_TO_INT(game_data->ball_pos_y) - LIVES_FONT_SIZE, LCD_HEIGHT - BALL_SIZE - LIVES_FONT_SIZE + 1, POLICY_Y_BINS);
+    int dir = is_right ? game_data->ball_vel_x > 0 : game_data->ball_vel_x < 0;
+    fixed_t speed = game_data->ball_vel_x < 0 ? -game_data->ball_vel_x : game_data->ball_vel_x;
+    fixed_t slope = speed ? FIXED_MUL_DIV(game_data->ball_vel_y, FIXED_ONE, speed) : 0;
+    int vel_y = policy_bin(slope + POLICY_MAX_SLOPE, 2 * POLICY_MAX_SLOPE, POLICY_VEL_Y_BINS);
+    int paddle_y = is_right ? game_data->paddle_right_pos : game_data->paddle_left_pos;
+    int paddle = policy_bin(paddle_y - LIVES_FONT_SIZE, LCD_HEIGHT - PADDLE_HEIGHT - LIVES_FONT_SIZE + 1, POLICY_PADDLE_BINS);
+    return (((x * POLICY_Y_BINS + y) * POLICY_DIR_BINS + dir) * POLICY_VEL_Y_BINS + vel_y) * POLICY_PADDLE_BINS + paddle;
+}
+
+/**
+ * Get the bin of a value, the values out of the range fall into the first or the last bin.
+ * @param value the value, from 0 to span - 1
+ * @param span the number of the values
+ * @param bins the number of the bins
+ * @return the bin, from 0 to bins - 1
+ */
+int policy_bin(int value, int span, int bins) {
+    if (value <= 0) return 0;
+    if (value >= span) return bins - 1;
+    return (int)((int64_t)value * bins / span);
+}
+
+/**
+ * Map a policy file into memory, it replaces the policy loaded before. \n
+ * The size and the header are checked and the checksum is taken from the header, the table itself is only read by the moves.
+ * @param path the path of the file
+ * @return 0 on success, -1 if the file cannot be read or is not a policy of this version and size
+ */
+int load_policy(char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) || file_stat.st_size != POLICY_FILE_SIZE) {
+        close(fd);
+        return -1;
+    }
+    void* map = mmap(NULL, POLICY_FILE_SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    unsigned char header[POLICY_HEADER_SIZE];
+    fill_policy_header(header);
+    if (memcmp(map, header, POLICY_CHECKSUM_OFFSET)) {
+        munmap(map, POLICY_FILE_SIZE);
+        return -1;
+    }
+    unload_policy();
+    policy = (unsigned char*)map;
+    // the checksum written by the trainer, the table itself is not read
+    policy_sum = 0;
+    for (int i = 0; i < 4; i++) policy_sum |= (uint32_t)policy[POLICY_CHECKSUM_OFFSET + i] << (8 * i);
+    return 0;
+}
+
+/**
+ * Map POLICY_FILE from the directory of the program into memory, a missing or invalid file is reported on stderr.
+ * @param program the path of the program, argv[0]
+ * @return 0 on success, -1 if there is no valid policy file
+ */
+int load_program_policy(char* program) {
+    char* slash = strrchr(program, '/');
+    int dir_length = slash ? slash - program + 1 : 0;
+    char* path = (char*)malloc(dir_length + sizeof(POLICY_FILE));
+    if (!path) {
+        print_log(LOG_HEAD_POLICY, "allocation error");
+        exit(1);
+    }
+    memcpy(path, program, dir_length);
+    strcpy(path + dir_length, POLICY_FILE);
+    int ret = load_policy(path);
+    // stdout carries the reports of the headless mode and the tournament
+    if (ret) fprintf(stderr, "%sno valid policy file, the learned AI follows the ball\n", LOG_HEAD_POLICY);
+    free(path);
+    return ret;
+}
+
+/**
+ * Unmap the policy, the AI follows the ball afterwards.
+ */
+void unload_policy(void) {
+    if (policy) munmap(policy, POLICY_FILE_SIZE);
+    policy = NULL;
+    policy_sum = 0;
+}
+
+/**
+ * Get the checksum of the loaded policy, replays store it to detect a game played with another table.
+ * @return the checksum of the moves of the table, 0 if no policy is loaded and the AI follows the ball
+ */
+uint32_t policy_checksum(void) {
+    return policy_sum;
+}
+
+/**
+ * Compute the checksum of the moves of a policy, FNV-1a of the table without the header.
+ * @param table the policy file, header included
+ * @return the checksum, never 0
+ */
+uint32_t compute_policy_checksum(unsigned char* table) {
+    uint32_t sum = 2166136261u;
+    for (int i = POLICY_HEADER_SIZE; i < POLICY_FILE_SIZE; i++) sum = (sum ^ table[i]) * 16777619u;
+    // 0 means that no policy is loaded
+    return sum ? sum : 1;
+}
+
+/**
+ * Write the header of a policy file with the dimensions of this version, the bytes of the checksum are left 0.
+ * @param header array of POLICY_HEADER_SIZE bytes to be filled
+ */
+void fill_policy_header(unsigned char* header) {
+    memset(header, 0, POLICY_HEADER_SIZE);
+    memcpy(header, POLICY_MAGIC, 4);
+    header[4] = POLICY_VERSION;
+    header[5] = POLICY_X_BINS;
+    header[6] = POLICY_Y_BINS;
+    header[7] = POLICY_DIR_BINS;
+    header[8] = POLICY_VEL_Y_BINS;
+    header[9] = POLICY_PADDLE_BINS;
+}
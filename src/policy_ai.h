@@ -0,0 +1,105 @@
+#ifndef POLICY_AI_H
+#define POLICY_AI_H
+
+/** @file
+ * This is an implementation of ai_interface.h \n
+ * The AI looks its move up in a policy table trained offline by the trainer (trainer.c). The table is indexed
+ * by the quantized state of the game as seen from the paddle: the distance of the ball from the paddle face,
+ * the y coordinate of the ball, whether the ball comes towards the paddle, the y velocity of the ball
+ * and the y coordinate of the paddle, the left paddle sees the court mirrored. The y velocity is taken relative
+ * to the x velocity, i.e. as the slope of the path, so the same table plays at every speed of the ball. \n
+ * The policy file is POLICY_HEADER_SIZE bytes of the header (POLICY_MAGIC, version byte, the number of bins
+ * of each dimension, one byte each, and the checksum of the moves, 4 bytes little endian) followed by one signed byte
+ * of the move for every state. It is mapped into memory as it is, nothing is parsed, the checksum is written
+ * by the trainer. Without a policy the AI follows the ball like the basic AI.
+ */
+
+#include "ai_interface.h"
+
+#define POLICY_MAGIC "APPT"
+#define POLICY_VERSION (2)
+#define POLICY_HEADER_SIZE (16)
+// the checksum of the moves is stored in the header from this byte, the bytes before it are given by the version
+#define POLICY_CHECKSUM_OFFSET (10)
+// the policy file is looked for in the directory of the program
+#define POLICY_FILE "pong_policy.bin"
+
+/* numbers of bins of the dimensions of the state */
+#define POLICY_X_BINS (16)
+#define POLICY_Y_BINS (16)
+#define POLICY_DIR_BINS (2)
+#define POLICY_VEL_Y_BINS (8)
+#define POLICY_PADDLE_BINS (16)
+#define POLICY_STATES (POLICY_X_BINS * POLICY_Y_BINS * POLICY_DIR_BINS * POLICY_VEL_Y_BINS * POLICY_PADDLE_BINS)
+#define POLICY_FILE_SIZE (POLICY_HEADER_SIZE + POLICY_STATES)
+// the steepest slope of the path of the ball, the y velocity bins split -POLICY_MAX_SLOPE to POLICY_MAX_SLOPE
+#define POLICY_MAX_SLOPE INT_TO_FIXED(BOUNCE_CONST)
+
+#define LOG_HEAD_POLICY "POLICY: "
+
+/**
+ * This funciton is called every game update to determine the AI's movement. \n
+ * It is the move function of the AI, see ai_interface.h.
+ * @param is_right 0 if the AI controls the left paddle, \n
+ *                 1 if the AI controls the right paddle
+ * @param game_data a structure containing all information about the state of the game
+ * @param state the state the AI keeps between updates for this paddle
+ * @param seed the state of the random numbers of the game, to be used with rand_r
+ * @return -1 for moving up \n
+ *          0 for not moving \n
+ *          1 for moving down
+ * @see game.h for struct game_data and struct ai_state
+ */
+char policy_ai_move(char is_right, struct game_data game_data, struct ai_state* state, unsigned int* seed);
+
+/** the AI playing the trained policy */
+extern const ai_interface_t policy_ai;
+
+/**
+ * Get the index of the state of the game in the policy table.
+ * @param is_right 0 for the left paddle, 1 for the right one
+ * @param game_data the state of the game
+ * @return the index of the state, from 0 to POLICY_STATES - 1
+ */
+int policy_index(char is_right, struct game_data* game_data);
+
+/**
+ * Map a policy file into memory, it replaces the policy loaded before. \n
+ * It is to be called before any game starts, the games only read the policy.
+ * @param path the path of the file
+ * @return 0 on success, -1 if the file cannot be read or is not a policy of this version and size
+ */
+int load_policy(char* path);
+
+/**
+ * Map POLICY_FILE from the directory of the program into memory, a missing or invalid file is reported on stderr.
+ * @param program the path of the program, argv[0]
+ * @return 0 on success, -1 if there is no valid policy file
+ */
+int load_program_policy(char* program);
+
+/**
+ * Unmap the policy, the AI follows the ball afterwards.
+ */
+void unload_policy(void);
+
+/**
+ * Get the checksum of the loaded policy, replays store it to detect a game played with another table.
+ * @return the checksum of the moves of the table, 0 if no policy is loaded and the AI follows the ball
+ */
+uint32_t policy_checksum(void);
+
+/**
+ * Compute the checksum of the moves of a policy, FNV-1a of the table without the header.
+ * @param table the policy file, header included
+ * @return the checksum, never 0
+ */
+uint32_t compute_policy_checksum(unsigned char* table);
+
+/**
+ * Write the header of a policy file with the dimensions of this version, the bytes of the checksum are left 0.
+ * @param header array of POLICY_HEADER_SIZE bytes to be filled
+ */
+void fill_policy_header(unsigned char* header);
+
+#endif
@@ -13,6 +13,7 @@
 #include <stdint.h>
 #include <time.h>
 #include <unistd.h>
+#include <string.h>
 
 #include "mzapo_parlcd.h"
 #include "mzapo_phys.h"
@@ -24,11 +25,18 @@
 #include "settings.h"
 #include "rgb565.h"
 #include "menu.h"
+#include "menu_events.h"
 #include "peripherals.h"
 #include "game.h"
 #include "player_input.h"
+#include "headless.h"
+#include "replay.h"
+#include "policy_ai.h"
 
 #define MAIN_HEADER "MAIN: "
+#define HEADLESS_OPTION "--headless"
+#define REPLAY_OPTION "--replay"
+#define RECORD_OPTION "--record"
 
 /**
  * compares score with current highscore and displays appropriate screen
@@ -57,6 +65,15 @@ void eval_score(int new_score, settings_t *settings, settings_fields_t *settings
  */
 int main(int argc, char *argv[]) {
 
+    /* the table of the learned AI is mapped once for the whole run */
+    load_program_policy(argv[0]);
+    /* bot matches without the display and the peripherals */
+    if (argc > 1 && !strcmp(argv[1], HEADLESS_OPTION)) return headless_main(argc - 1, argv + 1);
+    /* a recorded game played again */
+    if (argc > 1 && !strcmp(argv[1], REPLAY_OPTION)) return replay_main(argc - 1, argv + 1);
+    /* record the input of the games */
+    if (argc > 2 && !strcmp(argv[1], RECORD_OPTION)) record_games(argv[2]);
+
     unsigned char *lcd_membase = init_lcd();
 
     unsigned char *membase = init_peripherals();
@@ -105,6 +122,7 @@ int main(int argc, char *argv[]) {
     destroy_settings(settings);
     destroy_settings_fields(settings_fields);
     destroy_frame(frame);
+    destroy_menu_bitmaps();
     exit_input();
     return 0;
 }
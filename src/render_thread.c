@@ -0,0 +1,124 @@
+/** @file
+*/
+
+#define _GNU_SOURCE
+
+#include "render_thread.h"
+#include "game_view.h"
+#include "log.h"
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+
+// the shared index of the triple buffer carries this flag when it holds a snapshot not yet taken by the renderer
+#define FRESH_SNAPSHOT (4)
+#define SNAPSHOT_INDEX (3)
+
+void* render_loop(void* arg);
+char take_snapshot(void);
+
+static struct view_snapshot snapshots[3];
+static int back_index;   // written by the game thread only
+static int shared_index; // exchanged atomically between the threads
+static int front_index;  // read by the render thread only
+static sem_t snapshot_ready;
+static pthread_t render_thread;
+static char thread_running = 0;
+static volatile char stop_requested;
+
+/**
+ * Start the render thread. The game view has to be initialized before. \n
+ * If the thread cannot be started, the snapshots are rendered directly by publish_view().
+ * @param cpu index of the cpu core to pin the thread to, -1 for no pinning
+ */
+void start_render_thread(int cpu) {
+    back_index = 0;
+    shared_index = 1;
+    front_index = 2;
+    stop_requested = 0;
+    thread_running = 0;
+    if (!RENDER_THREAD_ENABLED) return;
+    if (sem_init(&snapshot_ready, 0, 0)) {
+        if (LOG_RENDER_THREAD) print_log(LOG_HEAD_RENDER_THREAD, "ERROR: semaphore not created, rendering on game thread");
+        return;
+    }
+    if (pthread_create(&render_thread, NULL, render_loop, NULL)) {
+        if (LOG_RENDER_THREAD) print_log(LOG_HEAD_RENDER_THREAD, "ERROR: thread not created, rendering on game thread");
+        sem_destroy(&snapshot_ready);
+        return;
+    }
+    thread_running = 1;
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        if (pthread_setaffinity_np(render_thread, sizeof(cpus), &cpus)) {
+            if (LOG_RENDER_THREAD) print_log(LOG_HEAD_RENDER_THREAD, "could not pin thread to the requested cpu");
+        }
+    }
+    if (LOG_RENDER_THREAD) print_log(LOG_HEAD_RENDER_THREAD, "started");
+}
+
+/**
+ * Hand a new state of the game to the renderer. Never blocks on the render thread.
+ * @param game_data the state of the game objects
+ * @param balls the balls of the multi-ball mode, NULL for the single ball in game_data
+ * @param score the current score of the player; is set to -1 in PvP mode
+ */
+void publish_view(struct game_data game_data, struct balls* balls, int score) {
+    if (!thread_running) {
+        update_view(game_data, balls, score);
+        return;
+    }
+    snapshots[back_index].data = game_data;
+    if (balls) {
+        copy_balls(&snapshots[back_index].balls, balls);
+    } else {
+        snapshots[back_index].balls.count = 0;
+    }
+    snapshots[back_index].score = score;
+    // swap the written slot with the shared one, the renderer may still hold an older fresh one which is dropped
+    back_index = __atomic_exchange_n(&shared_index, back_index | FRESH_SNAPSHOT, __ATOMIC_ACQ_REL) & SNAPSHOT_INDEX;
+    sem_post(&snapshot_ready);
+}
+
+/**
+ * Stop the render thread and wait for it to finish the frame it is drawing.
+ */
+void stop_render_thread(void) {
+    if (!thread_running) return;
+    stop_requested = 1;
+    sem_post(&snapshot_ready);
+    pthread_join(render_thread, NULL);
+    sem_destroy(&snapshot_ready);
+    thread_running = 0;
+    if (LOG_RENDER_THREAD) print_log(LOG_HEAD_RENDER_THREAD, "stopped");
+}
+
+/**
+ * Wait for published snapshots and render the newest one until stopped.
+ */
+void* render_loop(void* arg) {
+    while (1) {
+        sem_wait(&snapshot_ready);
+        // several snapshots could have been published while the last frame was rendered
+        while (sem_trywait(&snapshot_ready) == 0);
+        if (stop_requested) break;
+        if (take_snapshot()) {
+            struct view_snapshot* snapshot = &snapshots[front_index];
+            update_view(snapshot->data, snapshot->balls.count ? &snapshot->balls : NULL, snapshot->score);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Take the newest published snapshot into the front slot.
+ * @return 1 if a new snapshot has been taken, 0 if there was none
+ */
+char take_snapshot(void) {
+    if (!(__atomic_load_n(&shared_index, __ATOMIC_ACQUIRE) & FRESH_SNAPSHOT)) return 0;
+    front_index = __atomic_exchange_n(&shared_index, front_index, __ATOMIC_ACQ_REL) & SNAPSHOT_INDEX;
+    return 1;
+}
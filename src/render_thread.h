@@ -0,0 +1,50 @@
+/** @file
+ * Renders the game view on its own thread, so the game updates never wait for the lcd display. \n
+ * The game publishes snapshots of its state into a triple buffer and the render thread
+ * always draws the newest one, snapshots that are overwritten before they are drawn are skipped.
+ */
+
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include "game.h"
+
+// set to 0 to render on the game thread after every update
+#define RENDER_THREAD_ENABLED 1
+// index of the cpu core the render thread is pinned to, -1 to let the system place it
+#define RENDER_THREAD_CPU (1)
+
+#define LOG_HEAD_RENDER_THREAD "RENDER THREAD: "
+#define LOG_RENDER_THREAD 1
+
+/**
+ * One state of the game that is to be rendered.
+ */
+struct view_snapshot {
+    struct game_data data;
+    /** the balls of the multi-ball mode, count is 0 for the single ball in data */
+    struct balls balls;
+    int score;
+};
+
+/**
+ * Start the render thread. The game view has to be initialized before. \n
+ * If the thread cannot be started, the snapshots are rendered directly by publish_view().
+ * @param cpu index of the cpu core to pin the thread to, -1 for no pinning
+ */
+void start_render_thread(int cpu);
+
+/**
+ * Hand a new state of the game to the renderer. Never blocks on the render thread.
+ * @param game_data the state of the game objects
+ * @param balls the balls of the multi-ball mode, NULL for the single ball in game_data
+ * @param score the current score of the player; is set to -1 in PvP mode
+ */
+void publish_view(struct game_data game_data, struct balls* balls, int score);
+
+/**
+ * Stop the render thread and wait for it to finish the frame it is drawing.
+ */
+void stop_render_thread(void);
+
+#endif
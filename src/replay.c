@@ -0,0 +1,569 @@
+/** @file
+ * The file starts with the header: REPLAY_MAGIC, version byte, left, right, AI of the left and of the right paddle,
+ * difficulty (one byte each), the seed (4 bytes), the number of updates between keyframes (2 bytes)
+ * and the checksum of the policy of the learned AI (4 bytes). \n
+ * Then runs of equal inputs follow: the length of the run (varint), a byte with the keys and the flags of moved knobs
+ * and the movement of each moved knob (zigzag varint). \n
+ * Before the updates 0, REPLAY_KEYFRAME_INTERVAL, 2 * REPLAY_KEYFRAME_INTERVAL, ... a keyframe with the whole state
+ * of the game (KEYFRAME_FIELDS numbers of 4 bytes) is stored, runs never continue over a keyframe. \n
+ * A run of length 0 ends the input, it is followed by the number of updates and the final game_data and score (varints),
+ * by the index of the keyframes (file offsets of 4 bytes) and by the footer: the number of keyframes, the offset
+ * of the index (4 bytes each) and REPLAY_INDEX_MAGIC. All numbers of fixed size are little endian.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "replay.h"
+#include "graphics.h"
+#include "game_view.h"
+#include "render_thread.h"
+#include "tick_scheduler.h"
+#include "log.h"
+#include "policy_ai.h"
+#include "settings.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// bits of the input byte of a run
+#define KEY_BITS (2)
+#define KEY_UP (1)
+#define KEY_DOWN (2)
+#define LEFT_KNOB_MOVED (1 << 4)
+#define RIGHT_KNOB_MOVED (1 << 5)
+
+#define HEADER_SIZE (20)
+#define FOOTER_SIZE (12)
+#define FINAL_DATA_FIELDS (9)
+#define KEYFRAME_FIELDS (32 + 2 * AI_STATE_WORDS)
+#define KEYFRAME_SIZE (4 * KEYFRAME_FIELDS)
+
+void write_varint(FILE* file, unsigned long value);
+int read_varint(replay_reader_t* reader, unsigned long* value);
+void write_u32(FILE* file, uint32_t value);
+uint32_t get_u32(unsigned char* bytes);
+unsigned long zigzag(long value);
+long unzigzag(unsigned long value);
+void flush_run(replay_writer_t* writer);
+void write_keyframe(replay_writer_t* writer, game_ctx_t* ctx);
+int pack_ctx(game_ctx_t* ctx, int32_t* fields);
+void unpack_ctx(game_ctx_t* ctx, int32_t* fields);
+char same_input(struct tick_input* a, struct tick_input* b);
+void final_data_fields(struct game_data* data, int* score, int** fields);
+int play_replay(replay_reader_t* reader, game_ctx_t* ctx, char realtime);
+
+/**
+ * Fill the header of a replay from the context of a game that has just been initialized.
+ * @param header the header to be filled
+ * @param ctx the context of the game
+ */
+void replay_header_from_ctx(replay_header_t* header, game_ctx_t* ctx) {
+    header->seed = ctx->initial_seed;
+    header->left = ctx->settings->left;
+    header->right = ctx->settings->right;
+    header->ai[0] = ctx->ai[0];
+    header->ai[1] = ctx->ai[1];
+    header->difficulty = ctx->settings->difficulty;
+    header->policy = policy_checksum();
+}
+
+/**
+ * Create the replay file and write its header.
+ * @param writer the writer to be initialized
+ * @param path the path of the file
+ * @param header the seed and the settings of the game
+ * @return 0 on success, -1 if the file cannot be written
+ */
+int open_replay_writer(replay_writer_t* writer, char* path, replay_header_t* header) {
+    memset(writer, 0, sizeof(replay_writer_t));
+    writer->file = fopen(path, "wb");
+    if (!writer->file) return -1;
+    unsigned char bytes[HEADER_SIZE];
+    memcpy(bytes, REPLAY_MAGIC, 4);
+    bytes[4] = REPLAY_VERSION;
+    bytes[5] = header->left;
+    bytes[6] = header->right;
+    bytes[7] = header->ai[0];
+    bytes[8] = header->ai[1];
+    bytes[9] = header->difficulty;
+    for (int i = 0; i < 4; i++) bytes[10 + i] = header->seed >> (8 * i);
+    bytes[14] = REPLAY_KEYFRAME_INTERVAL & 0xff;
+    bytes[15] = REPLAY_KEYFRAME_INTERVAL >> 8;
+    for (int i = 0; i < 4; i++) bytes[16 + i] = header->policy >> (8 * i);
+    if (fwrite(bytes, 1, HEADER_SIZE, writer->file) != HEADER_SIZE) {
+        fclose(writer->file);
+        writer->file = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Record the input of one update, called before the update. \n
+ * Every REPLAY_KEYFRAME_INTERVAL updates the state of the game is stored as a keyframe.
+ * @param writer the writer of the replay
+ * @param ctx the context of the game, before the update
+ * @param input the input given to update()
+ */
+void record_tick(replay_writer_t* writer, game_ctx_t* ctx, struct tick_input input) {
+    if (writer->ticks % REPLAY_KEYFRAME_INTERVAL == 0) {
+        if (writer->run_length) flush_run(writer);
+        write_keyframe(writer, ctx);
+    }
+    if (writer->run_length && !same_input(&writer->run_input, &input)) flush_run(writer);
+    writer->run_input = input;
+    writer->run_length++;
+    writer->ticks++;
+}
+
+/**
+ * Write the remaining input, the final state of the game and the index of the keyframes and close the file.
+ * @param writer the writer of the replay
+ * @param ctx the context of the finished game
+ * @return 0 on success, -1 on a write error
+ */
+int close_replay_writer(replay_writer_t* writer, game_ctx_t* ctx) {
+    if (writer->run_length) flush_run(writer);
+    write_varint(writer->file, 0);
+    write_varint(writer->file, writer->ticks);
+    int* fields[FINAL_DATA_FIELDS];
+    final_data_fields(&ctx->data, &ctx->score, fields);
+    for (int i = 0; i < FINAL_DATA_FIELDS; i++) write_varint(writer->file, zigzag(*fields[i]));
+    long index_offset = ftell(writer->file);
+    for (int i = 0; i < writer->keyframe_count; i++) write_u32(writer->file, writer->keyframes[i]);
+    write_u32(writer->file, writer->keyframe_count);
+    write_u32(writer->file, index_offset);
+    fwrite(REPLAY_INDEX_MAGIC, 1, 4, writer->file);
+    free(writer->keyframes);
+    writer->keyframes = NULL;
+    int error = ferror(writer->file) || index_offset < 0;
+    if (fclose(writer->file)) error = 1;
+    writer->file = NULL;
+    return error ? -1 : 0;
+}
+
+/**
+ * Map a replay file into memory and read its header and the index of the keyframes.
+ * @param reader the reader to be initialized
+ * @param path the path of the file
+ * @return 0 on success, -1 if the file cannot be read or is not a replay
+ */
+int open_replay_reader(replay_reader_t* reader, char* path) {
+    memset(reader, 0, sizeof(replay_reader_t));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) || file_stat.st_size < HEADER_SIZE + FOOTER_SIZE) {
+        close(fd);
+        return -1;
+    }
+    void* map = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    reader->map = (unsigned char*)map;
+    reader->size = file_stat.st_size;
+    unsigned char* bytes = reader->map;
+    unsigned char* footer = reader->map + reader->size - FOOTER_SIZE;
+    uint32_t keyframe_count = get_u32(footer);
+    uint32_t index_offset = get_u32(footer + 4);
+    if (memcmp(bytes, REPLAY_MAGIC, 4) || bytes[4] != REPLAY_VERSION || memcmp(footer + 8, REPLAY_INDEX_MAGIC, 4)
+        || (bytes[14] | bytes[15] << 8) != REPLAY_KEYFRAME_INTERVAL || index_offset < HEADER_SIZE
+        || index_offset > reader->size - FOOTER_SIZE || keyframe_count != (reader->size - FOOTER_SIZE - index_offset) / 4) {
+        close_replay_reader(reader);
+        return -1;
+    }
+    reader->header.left = bytes[5];
+    reader->header.right = bytes[6];
+    reader->header.ai[0] = bytes[7];
+    reader->header.ai[1] = bytes[8];
+    reader->header.difficulty = bytes[9];
+    reader->header.seed = get_u32(bytes + 10);
+    reader->header.policy = get_u32(bytes + 16);
+    reader->input_end = index_offset;
+    reader->index = reader->map + index_offset;
+    reader->keyframe_count = keyframe_count;
+    for (int i = 0; i < reader->keyframe_count; i++) {
+        if (get_u32(reader->index + 4 * i) + KEYFRAME_SIZE > reader->input_end) {
+            close_replay_reader(reader);
+            return -1;
+        }
+    }
+    reader->pos = HEADER_SIZE;
+    madvise(reader->map, reader->size, MADV_SEQUENTIAL);
+    return 0;
+}
+
+/**
+ * Read the input of the next update.
+ * @param reader the reader of the replay
+ * @param input the input is stored here
+ * @return 1 if the input was read, 0 at the end of the recording, -1 if the file is damaged
+ */
+int read_tick(replay_reader_t* reader, struct tick_input* input) {
+    if (reader->finished) return 0;
+    if (!reader->run_left) {
+        // keyframes are needed only for seeking, sequential reading skips them
+        long keyframe = reader->ticks / REPLAY_KEYFRAME_INTERVAL;
+        if (reader->ticks % REPLAY_KEYFRAME_INTERVAL == 0 && keyframe < reader->keyframe_count
+            && reader->pos == get_u32(reader->index + 4 * keyframe)) {
+            reader->pos += KEYFRAME_SIZE;
+        }
+        unsigned long length, value;
+        if (read_varint(reader, &length)) return -1;
+        if (!length) {
+            int* fields[FINAL_DATA_FIELDS];
+            if (read_varint(reader, &value)) return -1;
+            reader->recorded_ticks = value;
+            final_data_fields(&reader->final_data, &reader->final_score, fields);
+            for (int i = 0; i < FINAL_DATA_FIELDS; i++) {
+                if (read_varint(reader, &value)) return -1;
+                *fields[i] = unzigzag(value);
+            }
+            reader->finished = 1;
+            return 0;
+        }
+        if (reader->pos >= reader->input_end) return -1;
+        int flags = reader->map[reader->pos++];
+        struct tick_input* run = &reader->run_input;
+        memset(run, 0, sizeof(struct tick_input));
+        for (int side = 0; side < 2; side++) {
+            int key = (flags >> (side * KEY_BITS)) & ((1 << KEY_BITS) - 1);
+            run->key_dir[side] = key == KEY_UP ? -1 : key == KEY_DOWN ? 1 : 0;
+            if (flags & (side ? RIGHT_KNOB_MOVED : LEFT_KNOB_MOVED)) {
+                if (read_varint(reader, &value)) return -1;
+                run->knob_diff[side] = unzigzag(value);
+            }
+        }
+        reader->run_left = length;
+    }
+    reader->run_left--;
+    reader->ticks++;
+    *input = reader->run_input;
+    return 1;
+}
+
+/**
+ * Restore the state the game had before the given update and continue reading the input from there. \n
+ * Costs one keyframe restore and at most REPLAY_KEYFRAME_INTERVAL - 1 updates.
+ * @param reader the reader of the replay
+ * @param ctx the context of the replayed game, initialized by init_replay_ctx()
+ * @param tick the number of updates the game should have run, larger values stop at the end of the recording
+ * @return 0 on success, -1 if the file is damaged
+ */
+int seek_replay(replay_reader_t* reader, game_ctx_t* ctx, long tick) {
+    if (!reader->keyframe_count) return 0;
+    long keyframe = tick < 0 ? 0 : tick / REPLAY_KEYFRAME_INTERVAL;
+    if (keyframe >= reader->keyframe_count) keyframe = reader->keyframe_count - 1;
+    uint32_t offset = get_u32(reader->index + 4 * keyframe);
+    int32_t fields[KEYFRAME_FIELDS];
+    for (int i = 0; i < KEYFRAME_FIELDS; i++) fields[i] = (int32_t)get_u32(reader->map + offset + 4 * i);
+    unpack_ctx(ctx, fields);
+    reader->pos = offset + KEYFRAME_SIZE;
+    reader->ticks = keyframe * REPLAY_KEYFRAME_INTERVAL;
+    reader->run_left = 0;
+    reader->finished = 0;
+    struct tick_input input;
+    int read = 1;
+    while (reader->ticks < tick && (read = read_tick(reader, &input)) == 1) update(ctx, input);
+    return read < 0 ? -1 : 0;
+}
+
+/**
+ * Unmap the replay file.
+ */
+void close_replay_reader(replay_reader_t* reader) {
+    if (reader->map) munmap(reader->map, reader->size);
+    reader->map = NULL;
+}
+
+/**
+ * Set up the settings and the context of a game the way they were when the replay was recorded.
+ * @param header the header of the replay
+ * @param settings the settings to be changed, must outlive the context
+ * @param ctx the context to be initialized
+ */
+void init_replay_ctx(replay_header_t* header, settings_t* settings, game_ctx_t* ctx) {
+    settings->left = header->left;
+    settings->right = header->right;
+    settings->ai = header->ai[0];
+    settings->difficulty = header->difficulty;
+    // only games of one ball are recorded
+    settings->ball_count = 1;
+    init_game_ctx(ctx, settings, NULL, header->seed);
+    set_game_ai(ctx, 0, header->ai[0]);
+    set_game_ai(ctx, 1, header->ai[1]);
+    ctx->logging = 0;
+}
+
+/**
+ * Entry point of "pong --replay [-v] [-s update] file", -v plays the game in real time on the display,
+ * -s jumps to the given update first.
+ * @return exit status of the program
+ */
+int replay_main(int argc, char* argv[]) {
+    char realtime = 0;
+    long seek = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "vs:")) != -1) {
+        if (opt == 'v') {
+            realtime = 1;
+        } else if (opt == 's') {
+            seek = atol(optarg);
+        } else {
+            optind = argc + 1;
+            break;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: pong --replay [-v] [-s update] file\n");
+        return 1;
+    }
+    replay_reader_t reader;
+    if (open_replay_reader(&reader, argv[optind])) {
+        fprintf(stderr, "%s is not a replay file\n", argv[optind]);
+        return 1;
+    }
+    // the moves of the learned AI come from the policy file, another table plays another game
+    if ((reader.header.ai[0] == POLICY_AI || reader.header.ai[1] == POLICY_AI) && reader.header.policy != policy_checksum()) {
+        fprintf(stderr, "the game was recorded with another policy of the learned AI (checksum 0x%08x, loaded 0x%08x)\n",
+                reader.header.policy, policy_checksum());
+        close_replay_reader(&reader);
+        return 1;
+    }
+    settings_t* settings = init_settings();
+    game_ctx_t ctx;
+    init_replay_ctx(&reader.header, settings, &ctx);
+    int ret = 0;
+    if (seek >= 0) {
+        long long seek_start = monotonic_ns();
+        ret = seek_replay(&reader, &ctx, seek);
+        long long seek_end = monotonic_ns();
+        printf("seek             update %ld in %.1f us, lives %d : %d, score %d\n", reader.ticks,
+               (double)(seek_end - seek_start) / NSEC_PER_USEC, ctx.data.lives_left, ctx.data.lives_right, ctx.score);
+    }
+    long long start = monotonic_ns();
+    if (!ret) ret = play_replay(&reader, &ctx, realtime);
+    double seconds = (double)(monotonic_ns() - start) / NSEC_PER_SEC;
+    close_replay_reader(&reader);
+    if (ret) {
+        fprintf(stderr, "the replay file is damaged\n");
+    } else {
+        char same = ctx.stats.ticks == reader.recorded_ticks && ctx.score == reader.final_score
+                    && !memcmp(&ctx.data, &reader.final_data, sizeof(struct game_data));
+        printf("updates          %ld, %d keyframes\n", ctx.stats.ticks, reader.keyframe_count);
+        printf("time             %.6f s, %.0f updates/s\n", seconds, seconds > 0 ? ctx.stats.ticks / seconds : 0.0);
+        printf("lives            %d : %d, score %d\n", ctx.data.lives_left, ctx.data.lives_right, ctx.score);
+        printf("reproduced       %s\n", same ? "yes" : "NO, the final state differs from the recording");
+        if (!same) ret = 1;
+    }
+    destroy_game_ctx(&ctx);
+    destroy_settings(settings);
+    return ret;
+}
+
+/**
+ * Drive update() by the recorded input, at full speed or paced and shown on the display.
+ * @return 0 on success, -1 if the file is damaged
+ */
+int play_replay(replay_reader_t* reader, game_ctx_t* ctx, char realtime) {
+    struct tick_input input;
+    int read = 1;
+    if (!realtime) {
+        while ((read = read_tick(reader, &input)) == 1) update(ctx, input);
+        return read < 0 ? -1 : 0;
+    }
+    unsigned char* lcd_membase = init_lcd();
+    parlcd_hx8357_init(lcd_membase);
+    init_view(lcd_membase, ctx->settings);
+    start_render_thread(RENDER_THREAD_CPU);
+    tick_scheduler_t scheduler;
+    init_tick_scheduler(&scheduler, UPDATES_PER_SECOND, MAX_CATCH_UP_UPDATES);
+    while (read == 1) {
+        int ticks = wait_for_ticks(&scheduler);
+        for (int i = 0; i < ticks && (read = read_tick(reader, &input)) == 1; i++) update(ctx, input);
+        publish_view(ctx->data, NULL, ctx->score);
+    }
+    stop_render_thread();
+    return read < 0 ? -1 : 0;
+}
+
+/**
+ * Write an unsigned number in 7 bit groups, the highest bit of a byte tells whether another byte follows.
+ */
+void write_varint(FILE* file, unsigned long value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+/**
+ * Read a number written by write_varint() from the input part of the mapped file.
+ * @return 0 on success, -1 at the end of the input or for a too long number
+ */
+int read_varint(replay_reader_t* reader, unsigned long* value) {
+    *value = 0;
+    for (unsigned int shift = 0; shift < 8 * sizeof(unsigned long); shift += 7) {
+        if (reader->pos >= reader->input_end) return -1;
+        int byte = reader->map[reader->pos++];
+        *value |= (unsigned long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return 0;
+    }
+    return -1;
+}
+
+/**
+ * Write a number of 4 bytes, little endian.
+ */
+void write_u32(FILE* file, uint32_t value) {
+    unsigned char bytes[4] = {value, value >> 8, value >> 16, value >> 24};
+    fwrite(bytes, 1, 4, file);
+}
+
+/**
+ * Read a number of 4 bytes, little endian.
+ */
+uint32_t get_u32(unsigned char* bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+/**
+ * Map a signed number to an unsigned one so that numbers close to zero stay small: 0, -1, 1, -2, ...
+ */
+unsigned long zigzag(long value) {
+    return ((unsigned long)value << 1) ^ (unsigned long)(value < 0 ? -1L : 0L);
+}
+
+/**
+ * Inverse of zigzag().
+ */
+long unzigzag(unsigned long value) {
+    return (long)(value >> 1) ^ -(long)(value & 1);
+}
+
+/**
+ * Write the current run of equal inputs.
+ */
+void flush_run(replay_writer_t* writer) {
+    struct tick_input* input = &writer->run_input;
+    int flags = 0;
+    for (int side = 0; side < 2; side++) {
+        int key = input->key_dir[side] == -1 ? KEY_UP : input->key_dir[side] == 1 ? KEY_DOWN : 0;
+        flags |= key << (side * KEY_BITS);
+        if (input->knob_diff[side]) flags |= side ? RIGHT_KNOB_MOVED : LEFT_KNOB_MOVED;
+    }
+    write_varint(writer->file, writer->run_length);
+    fputc(flags, writer->file);
+    for (int side = 0; side < 2; side++) {
+        if (input->knob_diff[side]) write_varint(writer->file, zigzag(input->knob_diff[side]));
+    }
+    writer->run_length = 0;
+}
+
+/**
+ * Store the whole state of the game before the current update and remember its offset for the index.
+ */
+void write_keyframe(replay_writer_t* writer, game_ctx_t* ctx) {
+    if (writer->keyframe_count == writer->keyframe_capacity) {
+        writer->keyframe_capacity = writer->keyframe_capacity ? 2 * writer->keyframe_capacity : 64;
+        writer->keyframes = (uint32_t*)realloc(writer->keyframes, writer->keyframe_capacity * sizeof(uint32_t));
+        if (writer->keyframes == NULL) {
+            print_log(LOG_HEAD_REPLAY, "allocation error");
+            exit(1);
+        }
+    }
+    writer->keyframes[writer->keyframe_count++] = ftell(writer->file);
+    int32_t fields[KEYFRAME_FIELDS];
+    pack_ctx(ctx, fields);
+    for (int i = 0; i < KEYFRAME_FIELDS; i++) write_u32(writer->file, (uint32_t)fields[i]);
+}
+
+/**
+ * Collect the state of the game into KEYFRAME_FIELDS numbers, the settings, leds and logging are not part of it.
+ * @return the number of stored numbers
+ */
+int pack_ctx(game_ctx_t* ctx, int32_t* fields) {
+    int n = 0;
+    int* data_fields[FINAL_DATA_FIELDS];
+    final_data_fields(&ctx->data, &ctx->score, data_fields);
+    for (int i = 0; i < FINAL_DATA_FIELDS; i++) fields[n++] = *data_fields[i];
+    fields[n++] = ctx->ball_speed;
+    fields[n++] = ctx->running;
+    fields[n++] = (int32_t)ctx->seed;
+    fields[n++] = (int32_t)ctx->initial_seed;
+    fields[n++] = (int32_t)ctx->led_line;
+    fields[n++] = ctx->led_line_dir;
+    for (int side = 0; side < 2; side++) {
+        fields[n++] = ctx->ai[side];
+        fields[n++] = ctx->last_key[side];
+        fields[n++] = ctx->hit_blink_countdown[side];
+        fields[n++] = ctx->ball_loss_blink_countdown[side];
+        for (int i = 0; i < AI_STATE_WORDS; i++) fields[n++] = ctx->ai_state[side].words[i];
+        fields[n++] = ctx->stats.hits[side];
+        fields[n++] = ctx->stats.balls_lost[side];
+    }
+    fields[n++] = ctx->stats.ticks;
+    fields[n++] = ctx->stats.rallies;
+    fields[n++] = ctx->stats.rally_hits;
+    fields[n++] = ctx->stats.longest_rally;
+    fields[n++] = ctx->stats.winner;
+    return n;
+}
+
+/**
+ * Restore the state of the game stored by pack_ctx().
+ */
+void unpack_ctx(game_ctx_t* ctx, int32_t* fields) {
+    int n = 0;
+    int* data_fields[FINAL_DATA_FIELDS];
+    final_data_fields(&ctx->data, &ctx->score, data_fields);
+    for (int i = 0; i < FINAL_DATA_FIELDS; i++) *data_fields[i] = fields[n++];
+    ctx->ball_speed = fields[n++];
+    ctx->running = fields[n++];
+    ctx->seed = (unsigned int)fields[n++];
+    ctx->initial_seed = (unsigned int)fields[n++];
+    ctx->led_line = (uint32_t)fields[n++];
+    ctx->led_line_dir = fields[n++];
+    for (int side = 0; side < 2; side++) {
+        ctx->ai[side] = fields[n++];
+        ctx->last_key[side] = fields[n++];
+        ctx->hit_blink_countdown[side] = fields[n++];
+        ctx->ball_loss_blink_countdown[side] = fields[n++];
+        for (int i = 0; i < AI_STATE_WORDS; i++) ctx->ai_state[side].words[i] = fields[n++];
+        ctx->stats.hits[side] = fields[n++];
+        ctx->stats.balls_lost[side] = fields[n++];
+    }
+    ctx->stats.ticks = fields[n++];
+    ctx->stats.rallies = fields[n++];
+    ctx->stats.rally_hits = fields[n++];
+    ctx->stats.longest_rally = fields[n++];
+    ctx->stats.winner = fields[n++];
+}
+
+/**
+ * Compare two inputs.
+ * @return 1 if the inputs are the same, 0 otherwise
+ */
+char same_input(struct tick_input* a, struct tick_input* b) {
+    return a->key_dir[0] == b->key_dir[0] && a->key_dir[1] == b->key_dir[1]
+           && a->knob_diff[0] == b->knob_diff[0] && a->knob_diff[1] == b->knob_diff[1];
+}
+
+/**
+ * Collect pointers to the fields of the final state stored at the end of the replay, in the order of the file.
+ */
+void final_data_fields(struct game_data* data, int* score, int** fields) {
+    fields[0] = &data->ball_pos_x;
+    fields[1] = &data->ball_pos_y;
+    fields[2] = &data->ball_vel_x;
+    fields[3] = &data->ball_vel_y;
+    fields[4] = &data->paddle_left_pos;
+    fields[5] = &data->paddle_right_pos;
+    fields[6] = &data->lives_left;
+    fields[7] = &data->lives_right;
+    fields[8] = score;
+}
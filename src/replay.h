@@ -0,0 +1,154 @@
+/** @file
+ * Records the input of a game into a compact binary file and plays the game again from it. \n
+ * The game is deterministic for a given seed, settings and input of every update, so the file holds just these: \n
+ * a header with the seed and the settings, the input of the updates as runs of equal inputs
+ * and, at the end, the final state of the game to check the replay against. \n
+ * Every REPLAY_KEYFRAME_INTERVAL updates the whole state of the game is stored as a keyframe and an index
+ * of the keyframes is stored at the end of the file, so a replay can jump to any update by restoring
+ * the nearest keyframe and running at most REPLAY_KEYFRAME_INTERVAL - 1 updates.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "game.h"
+
+#define REPLAY_MAGIC "APRP"
+#define REPLAY_VERSION (8)
+#define REPLAY_INDEX_MAGIC "APIX"
+// updates between two keyframes, bounds the number of updates run by a seek (10 seconds of game time)
+#define REPLAY_KEYFRAME_INTERVAL (UPDATES_PER_SECOND * 10)
+
+#define LOG_HEAD_REPLAY "REPLAY: "
+
+/**
+ * What is needed besides the input to play a recorded game again.
+ */
+typedef struct replay_header {
+    unsigned int seed;
+    int left, right;
+    int ai[2];
+    int difficulty;
+    /** the checksum of the policy of the learned AI, see policy_checksum() */
+    uint32_t policy;
+} replay_header_t;
+
+/**
+ * Writes the input of a game into a file.
+ */
+typedef struct replay_writer {
+    FILE* file;
+    /** the input repeated in the current run and the length of the run */
+    struct tick_input run_input;
+    long run_length;
+    long ticks;
+    /** file offsets of the keyframes, one per REPLAY_KEYFRAME_INTERVAL updates */
+    uint32_t* keyframes;
+    int keyframe_count, keyframe_capacity;
+} replay_writer_t;
+
+/**
+ * Reads the input of a recorded game.
+ */
+typedef struct replay_reader {
+    /** the whole file mapped into memory and the position of the next byte to be read */
+    unsigned char* map;
+    size_t size, pos;
+    /** the end of the input and the keyframes */
+    size_t input_end;
+    /** the index of the keyframes: file offsets stored as 4 bytes little endian */
+    unsigned char* index;
+    int keyframe_count;
+    replay_header_t header;
+    struct tick_input run_input;
+    long run_left;
+    long ticks;
+    char finished;
+    /** the number of updates and the final state stored at the end of the file, valid once finished */
+    long recorded_ticks;
+    struct game_data final_data;
+    int final_score;
+} replay_reader_t;
+
+/**
+ * Fill the header of a replay from the context of a game that has just been initialized.
+ * @param header the header to be filled
+ * @param ctx the context of the game
+ */
+void replay_header_from_ctx(replay_header_t* header, game_ctx_t* ctx);
+
+/**
+ * Create the replay file and write its header.
+ * @param writer the writer to be initialized
+ * @param path the path of the file
+ * @param header the seed and the settings of the game
+ * @return 0 on success, -1 if the file cannot be written
+ */
+int open_replay_writer(replay_writer_t* writer, char* path, replay_header_t* header);
+
+/**
+ * Record the input of one update, called before the update. \n
+ * Every REPLAY_KEYFRAME_INTERVAL updates the state of the game is stored as a keyframe.
+ * @param writer the writer of the replay
+ * @param ctx the context of the game, before the update
+ * @param input the input given to update()
+ */
+void record_tick(replay_writer_t* writer, game_ctx_t* ctx, struct tick_input input);
+
+/**
+ * Write the remaining input, the final state of the game and the index of the keyframes and close the file.
+ * @param writer the writer of the replay
+ * @param ctx the context of the finished game
+ * @return 0 on success, -1 on a write error
+ */
+int close_replay_writer(replay_writer_t* writer, game_ctx_t* ctx);
+
+/**
+ * Map a replay file into memory and read its header and the index of the keyframes.
+ * @param reader the reader to be initialized
+ * @param path the path of the file
+ * @return 0 on success, -1 if the file cannot be read or is not a replay
+ */
+int open_replay_reader(replay_reader_t* reader, char* path);
+
+/**
+ * Read the input of the next update.
+ * @param reader the reader of the replay
+ * @param input the input is stored here
+ * @return 1 if the input was read, 0 at the end of the recording, -1 if the file is damaged
+ */
+int read_tick(replay_reader_t* reader, struct tick_input* input);
+
+/**
+ * Restore the state the game had before the given update and continue reading the input from there. \n
+ * Costs one keyframe restore and at most REPLAY_KEYFRAME_INTERVAL - 1 updates.
+ * @param reader the reader of the replay
+ * @param ctx the context of the replayed game, initialized by init_replay_ctx()
+ * @param tick the number of updates the game should have run, larger values stop at the end of the recording
+ * @return 0 on success, -1 if the file is damaged
+ */
+int seek_replay(replay_reader_t* reader, game_ctx_t* ctx, long tick);
+
+/**
+ * Unmap the replay file.
+ */
+void close_replay_reader(replay_reader_t* reader);
+
+/**
+ * Set up the settings and the context of a game the way they were when the replay was recorded.
+ * @param header the header of the replay
+ * @param settings the settings to be changed, must outlive the context
+ * @param ctx the context to be initialized
+ */
+void init_replay_ctx(replay_header_t* header, settings_t* settings, game_ctx_t* ctx);
+
+/**
+ * Entry point of "pong --replay [-v] [-s update] file", -v plays the game in real time on the display,
+ * -s jumps to the given update first. A game of the learned AI recorded with another policy is refused.
+ * @return exit status of the program
+ */
+int replay_main(int argc, char* argv[]);
+
+#endif
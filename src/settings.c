@@ -4,6 +4,7 @@
  */
 
 #include "settings.h"
+#include "ai_registry.h"
 
 /**
  * allocates memory for settings structure and sets default values \n
@@ -20,11 +21,12 @@ settings_t *init_settings(void) {
     settings->difficulty = MEDIUM;
     settings->difficulty_label = MEDIUM_LABEL;
     settings->ai = DUMB_AI;
-    settings->ai_label = DUMB_AI_LABEL;
+    settings->ai_label = get_ai(DUMB_AI)->label;
     settings->highscore = 0;
     settings->ballcolor = WHITE;
     settings->paddlecolors[0] = WHITE;
     settings->paddlecolors[1] = WHITE;
+    settings->ball_count = 1;
     return settings;
 }
 
@@ -70,14 +72,15 @@ settings_fields_t *init_settings_fields(void) {
     settings->difficulties[EASY] = "EASY";
     settings->difficulties[MEDIUM] = "MEDIUM";
     settings->difficulties[HARD] = "HARD";
-    settings->ai_count = AI_COUNT;
+    settings->ai_count = get_ai_count();
     settings->ai_labels = (char**)malloc(settings->ai_count * sizeof(char *));
     if (settings->ai_labels == NULL) {
         print_log(SETTINGS_HEADER, "error in ai labels allocation");
         exit(1);
     }
-    settings->ai_labels[DUMB_AI] = DUMB_AI_LABEL;
-    settings->ai_labels[SMARTER_AI] = SMARTER_AI_LABEL;
+    for (int i = 0; i < settings->ai_count; i++) {
+        settings->ai_labels[i] = get_ai(i)->label;
+    }
     settings->highscores = (int*)malloc(settings->ai_count * sizeof(int));
     if (settings->highscores == NULL) {
         print_log(SETTINGS_HEADER, "error in highscores allocation");
@@ -29,13 +29,16 @@
 
 #define COLOR_COUNT 6
 #define DIFFICULTY_COUNT 3
-#define AI_COUNT 2
 
+/* ids of the AIs in the registry of ai_registry.c */
 #define DUMB_AI 0
 #define SMARTER_AI 1
+#define EXPERT_AI 2
+#define POLICY_AI 3
+#define HUMAN_AI 4
 
-#define DUMB_AI_LABEL "DUMB"
-#define SMARTER_AI_LABEL "SMART"
+/* number of balls in the multi-ball mode, at most MAX_BALLS of game.h */
+#define MULTI_BALL_COUNT 24
 
 /**
  * structure that holds current values of settings
@@ -59,6 +62,8 @@ typedef struct settings {
     int left;
     /** right is player (PLAYER) or ai (BOT) */
     int right;
+    /** number of balls in the game, more than 1 in the multi-ball mode */
+    int ball_count;
 } settings_t;
 
 /**
@@ -4,6 +4,13 @@
  */
 
 #include "text.h"
+#include <string.h>
+
+/* the cache is used by one thread at a time (menu or game view, never both) */
+static glyph_t glyph_slots[GLYPH_CACHE_SLOTS];
+static int glyph_count = 0;
+static uint16_t glyph_pixels[GLYPH_CACHE_BUDGET / sizeof(uint16_t)];
+static size_t glyph_pixels_used = 0;
 
 /**
  * gets width of passed character in passed font
@@ -45,36 +52,110 @@ int get_string_width(font_descriptor_t *font, char *string) {
 }
 
 /**
- * puts char on passed cooridnates in frame buffer
+ * draws pixels of a char from the font bitmap into passed buffer
  *
- * @param x horizontal coordinate of top-left corner of the character
- * @param y vertical coordinate of top-left corner of the character
- * @param frame buffer to put char pixels int
+ * @param pixels buffer of width * font height pixels
  * @param font font descriptor in which font is char written
- * @param ch char the is being put
+ * @param ch char that is being drawn
+ * @param width width of the char in pixels
  * @param text_color color of the char in rgb 565 format
  * @param background_color color of the pixels around the char in rgb 565
  */
-void put_char(int x, int y, uint16_t *frame, font_descriptor_t *font, char ch, uint16_t text_color, uint16_t background_color) {
-    int x0 = x;
+static void rasterize_char(uint16_t *pixels, font_descriptor_t *font, char ch, int width, uint16_t text_color, uint16_t background_color) {
     uint32_t offset = font->offset[(int)ch - font->firstchar];
-    int width = get_char_width(font, ch);
     uint16_t bits = 0x0u;
     for (int i = 0; i < font->height; i++) {
-        for (int j = 0; j < width ; j++) {
+        for (int j = 0; j < width; j++) {
             if (j % 16 == 0) {
                 bits = font->bits[offset++];
             }
-            if (bits & MASK) {
-                put_pixel(x, y, text_color, frame);
-            } else {
-                put_pixel(x, y, background_color, frame);
-            }
+            *pixels++ = bits & MASK ? text_color : background_color;
             bits = bits << 1;
-            x++;
         }
-        x = x0;
-        y++;
+    }
+}
+
+/**
+ * empties the glyph cache
+ */
+void clear_glyph_cache(void) {
+    memset(glyph_slots, 0, sizeof(glyph_slots));
+    glyph_count = 0;
+    glyph_pixels_used = 0;
+}
+
+/**
+ * gets character drawn in passed colors from the glyph cache \n
+ * the character is drawn and stored in the cache if it is not there yet
+ *
+ * @param font font descriptor in which font is char written
+ * @param ch char that is desired
+ * @param text_color color of the char in rgb 565 format
+ * @param background_color color of the pixels around the char in rgb 565
+ *
+ * @returns pointer to cached glyph \n
+ *          NULL if the font does not contain the char
+ */
+glyph_t *get_glyph(font_descriptor_t *font, char ch, uint16_t text_color, uint16_t background_color) {
+    int width = get_char_width(font, ch);
+    if (width <= 0) return NULL;
+    uint32_t hash = ((uint32_t)(uintptr_t)font >> 4) * 31u + (unsigned char)ch;
+    hash = hash * 0x9e3779b1u ^ ((uint32_t)text_color << 16 | background_color);
+    hash ^= hash >> 15;
+    /* open addressing, the first empty place ends the search */
+    int i = hash & (GLYPH_CACHE_SLOTS - 1);
+    while (glyph_slots[i].font) {
+        glyph_t *glyph = &glyph_slots[i];
+        if (glyph->font == font && glyph->ch == ch && glyph->text_color == text_color && glyph->background_color == background_color) {
+            return glyph;
+        }
+        i = (i + 1) & (GLYPH_CACHE_SLOTS - 1);
+    }
+    /* not cached, start over with empty cache when the new glyph does not fit */
+    size_t size = (size_t)width * font->height;
+    if (glyph_pixels_used + size > sizeof(glyph_pixels) / sizeof(uint16_t) || glyph_count >= GLYPH_CACHE_SLOTS / 2) {
+        if (size > sizeof(glyph_pixels) / sizeof(uint16_t)) return NULL;
+        clear_glyph_cache();
+        i = hash & (GLYPH_CACHE_SLOTS - 1);
+    }
+    glyph_t *glyph = &glyph_slots[i];
+    glyph->font = font;
+    glyph->ch = ch;
+    glyph->text_color = text_color;
+    glyph->background_color = background_color;
+    glyph->width = width;
+    glyph->height = font->height;
+    glyph->pixels = glyph_pixels + glyph_pixels_used;
+    glyph_pixels_used += size;
+    glyph_count++;
+    rasterize_char(glyph->pixels, font, ch, width, text_color, background_color);
+    return glyph;
+}
+
+/**
+ * puts char on passed cooridnates in frame buffer \n
+ * the char is copied row by row from the glyph cache, parts outside of the display are cut off
+ *
+ * @param x horizontal coordinate of top-left corner of the character
+ * @param y vertical coordinate of top-left corner of the character
+ * @param frame buffer to put char pixels int
+ * @param font font descriptor in which font is char written
+ * @param ch char the is being put
+ * @param text_color color of the char in rgb 565 format
+ * @param background_color color of the pixels around the char in rgb 565
+ */
+void put_char(int x, int y, uint16_t *frame, font_descriptor_t *font, char ch, uint16_t text_color, uint16_t background_color) {
+    glyph_t *glyph = get_glyph(font, ch, text_color, background_color);
+    if (glyph == NULL) return;
+    /* clip the glyph to the display once */
+    int first_col = x < 0 ? -x : 0;
+    int last_col = x + glyph->width > LCD_WIDTH ? LCD_WIDTH - x : glyph->width;
+    int first_row = y < 0 ? -y : 0;
+    int last_row = y + glyph->height > LCD_HEIGHT ? LCD_HEIGHT - y : glyph->height;
+    if (first_col >= last_col || first_row >= last_row) return;
+    size_t row_size = (last_col - first_col) * sizeof(uint16_t);
+    for (int row = first_row; row < last_row; row++) {
+        memcpy(frame + (y + row) * LCD_WIDTH + x + first_col, glyph->pixels + row * glyph->width + first_col, row_size);
     }
 }
 
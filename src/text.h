@@ -13,6 +13,31 @@
 /* mask to get if first bit is 1 or 0 */
 #define MASK 0x8000u
 
+/* memory for pixels of cached glyphs in bytes, when it is full the cache is emptied */
+#define GLYPH_CACHE_BUDGET (512 * 1024)
+/* number of places for glyphs in the cache, has to be power of two */
+#define GLYPH_CACHE_SLOTS 1024
+
+/**
+ * structure that holds one character of a font already drawn in pixels of given colors
+ */
+typedef struct glyph {
+    /** font of the character, NULL for empty place in the cache */
+    font_descriptor_t *font;
+    /** the character */
+    char ch;
+    /** color of the character in rgb 565 format */
+    uint16_t text_color;
+    /** color of the pixels around the character in rgb 565 format */
+    uint16_t background_color;
+    /** width of the character in pixels */
+    int width;
+    /** height of the character in pixels */
+    int height;
+    /** pixels of the character row by row */
+    uint16_t *pixels;
+} glyph_t;
+
 /**
  * gets width of passed character in passed font
  *
@@ -34,7 +59,27 @@ int get_char_width(font_descriptor_t *font, char ch);
 int get_string_width(font_descriptor_t *font, char *string);
 
 /**
- * puts char on passed cooridnates in frame buffer
+ * gets character drawn in passed colors from the glyph cache \n
+ * the character is drawn and stored in the cache if it is not there yet
+ *
+ * @param font font descriptor in which font is char written
+ * @param ch char that is desired
+ * @param text_color color of the char in rgb 565 format
+ * @param background_color color of the pixels around the char in rgb 565
+ *
+ * @returns pointer to cached glyph \n
+ *          NULL if the font does not contain the char
+ */
+glyph_t *get_glyph(font_descriptor_t *font, char ch, uint16_t text_color, uint16_t background_color);
+
+/**
+ * empties the glyph cache
+ */
+void clear_glyph_cache(void);
+
+/**
+ * puts char on passed cooridnates in frame buffer \n
+ * the char is copied row by row from the glyph cache, parts outside of the display are cut off
  *
  * @param x horizontal coordinate of top-left corner of the character
  * @param y vertical coordinate of top-left corner of the character
@@ -0,0 +1,70 @@
+/** @file
+*/
+
+#include "tick_scheduler.h"
+#include <errno.h>
+
+long long timespec_to_ns(struct timespec time);
+struct timespec ns_to_timespec(long long ns);
+
+/**
+ * Get the current time of the monotonic clock.
+ * @return the time in nanoseconds
+ */
+long long monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return timespec_to_ns(now);
+}
+
+/**
+ * Initialize the scheduler, the first tick is due one period from now.
+ * @param scheduler the scheduler to initialize
+ * @param ticks_per_second the rate of the ticks
+ * @param max_catch_up the maximum number of ticks run at once after a late wake up (at least 1)
+ */
+void init_tick_scheduler(tick_scheduler_t* scheduler, int ticks_per_second, int max_catch_up) {
+    scheduler->period = NSEC_PER_SEC / ticks_per_second;
+    scheduler->max_catch_up = max_catch_up < 1 ? 1 : max_catch_up;
+    scheduler->ticks = 0;
+    scheduler->overruns = 0;
+    scheduler->dropped_ticks = 0;
+    scheduler->next_tick = ns_to_timespec(monotonic_ns() + scheduler->period);
+}
+
+/**
+ * Sleep until the next tick is due.
+ * @param scheduler the scheduler
+ * @return the number of ticks that are due, between 1 and max_catch_up
+ */
+int wait_for_ticks(tick_scheduler_t* scheduler) {
+    // the sleep is restarted with the same absolute deadline when interrupted by a signal
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &scheduler->next_tick, NULL) == EINTR);
+    long long deadline = timespec_to_ns(scheduler->next_tick);
+    long long late = monotonic_ns() - deadline;
+    long long due = late > 0 ? 1 + late / scheduler->period : 1;
+    if (due > 1) scheduler->overruns++;
+    // the deadlines of all due ticks are consumed, the dropped ones are never run
+    scheduler->next_tick = ns_to_timespec(deadline + due * scheduler->period);
+    if (due > scheduler->max_catch_up) {
+        scheduler->dropped_ticks += due - scheduler->max_catch_up;
+        due = scheduler->max_catch_up;
+    }
+    scheduler->ticks += due;
+    return (int)due;
+}
+
+/**
+ * Convert the given time to nanoseconds.
+ */
+long long timespec_to_ns(struct timespec time) {
+    return (long long)time.tv_sec * NSEC_PER_SEC + time.tv_nsec;
+}
+
+/**
+ * Convert the given number of nanoseconds to struct timespec.
+ */
+struct timespec ns_to_timespec(long long ns) {
+    struct timespec time = {.tv_sec = ns / NSEC_PER_SEC, .tv_nsec = ns % NSEC_PER_SEC};
+    return time;
+}
@@ -0,0 +1,55 @@
+/** @file
+ * Paces game updates to a fixed rate using absolute deadlines on the monotonic clock. \n
+ * The thread sleeps until the next deadline instead of spinning. When it wakes up late,
+ * the missed updates are run to catch up, but at most a given number of them at once.
+ */
+
+#ifndef TICK_SCHEDULER_H
+#define TICK_SCHEDULER_H
+
+#include <time.h>
+
+#define NSEC_PER_SEC (1000000000LL)
+#define NSEC_PER_MSEC (1000000LL)
+#define NSEC_PER_USEC (1000LL)
+
+/**
+ * State of the tick scheduler.
+ */
+typedef struct tick_scheduler {
+    /** the deadline of the next tick on the monotonic clock */
+    struct timespec next_tick;
+    /** the time between two ticks in nanoseconds */
+    long long period;
+    /** the maximum number of ticks returned by one wait_for_ticks() call */
+    int max_catch_up;
+    /** the number of ticks returned so far */
+    unsigned long ticks;
+    /** the number of wake ups later than one whole period after the deadline */
+    unsigned long overruns;
+    /** the number of ticks dropped because there were more than max_catch_up of them */
+    unsigned long dropped_ticks;
+} tick_scheduler_t;
+
+/**
+ * Get the current time of the monotonic clock.
+ * @return the time in nanoseconds
+ */
+long long monotonic_ns(void);
+
+/**
+ * Initialize the scheduler, the first tick is due one period from now.
+ * @param scheduler the scheduler to initialize
+ * @param ticks_per_second the rate of the ticks
+ * @param max_catch_up the maximum number of ticks run at once after a late wake up (at least 1)
+ */
+void init_tick_scheduler(tick_scheduler_t* scheduler, int ticks_per_second, int max_catch_up);
+
+/**
+ * Sleep until the next tick is due.
+ * @param scheduler the scheduler
+ * @return the number of ticks that are due, between 1 and max_catch_up
+ */
+int wait_for_ticks(tick_scheduler_t* scheduler);
+
+#endif
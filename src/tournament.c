@@ -0,0 +1,151 @@
+/** @file
+ * Tournament of all AI implementations against each other at every difficulty. \n
+ * Every ordered pairing (left AI, right AI) plays the same number of matches with the same seeds
+ * on all cpu cores using the headless mode, i.e. with the collision code of game.c. \n
+ * Usage: tournament [-n matches] [-s seed] [-t threads] [-c]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "game.h"
+#include "headless.h"
+#include "policy_ai.h"
+#include "settings.h"
+
+// z-score of the 95% confidence interval
+#define CONFIDENCE_Z (1.96)
+
+/**
+ * Wilson score interval of a win rate.
+ * @param wins the number of won matches
+ * @param n the number of decided matches
+ * @param low the lower bound of the interval is stored here
+ * @param high the upper bound of the interval is stored here
+ */
+void wilson_interval(int wins, int n, double* low, double* high) {
+    if (n <= 0) {
+        *low = 0;
+        *high = 1;
+        return;
+    }
+    double z2 = CONFIDENCE_Z * CONFIDENCE_Z;
+    double p = (double)wins / n;
+    double center = (p + z2 / (2 * n)) / (1 + z2 / n);
+    double spread = CONFIDENCE_Z * sqrt(p * (1 - p) / n + z2 / (4.0 * n * n)) / (1 + z2 / n);
+    // the rounding makes the bounds slightly out of range for 0 or n wins
+    *low = center - spread > 0 ? center - spread : 0;
+    *high = center + spread < 1 ? center + spread : 1;
+}
+
+/**
+ * Print one row of the results: the win rate of the first AI against the second one. \n
+ * The rally of a drawn match is not finished, it is counted as one more rally for the average rally length.
+ * Without decided matches the win rate and its interval are n/a.
+ */
+void print_row(char csv, char* difficulty, char* first, char* second, int wins, int losses, int draws,
+               long long hits, long long rallies, long long ticks, double seconds) {
+    double low, high;
+    int decided = wins + losses;
+    wilson_interval(wins, decided, &low, &high);
+    double rate = decided ? (double)wins / decided : 0;
+    double rally = rallies + draws ? (double)hits / (rallies + draws) : 0;
+    double speed = seconds > 0 ? ticks / seconds : 0;
+    if (csv && !decided) {
+        printf("%s,%s,%s,%d,%d,%d,n/a,n/a,n/a,%.2f,%.0f\n", difficulty, first, second, wins, losses, draws, rally, speed);
+    } else if (csv) {
+        printf("%s,%s,%s,%d,%d,%d,%.4f,%.4f,%.4f,%.2f,%.0f\n", difficulty, first, second, wins, losses, draws, rate, low, high, rally, speed);
+    } else if (!decided) {
+        printf("%-7s %-6s vs %-6s %6d %6d %5d  %-23s  %7.2f  %11.0f\n", difficulty, first, second,
+               wins, losses, draws, "  n/a", rally, speed);
+    } else {
+        printf("%-7s %-6s vs %-6s %6d %6d %5d  %5.1f%% [%5.1f%%, %5.1f%%]  %7.2f  %11.0f\n", difficulty, first, second,
+               wins, losses, draws, 100 * rate, 100 * low, 100 * high, rally, speed);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int match_count = 1000;
+    unsigned int seed = 1;
+    int thread_count = 0;
+    char csv = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:t:c")) != -1) {
+        switch (opt) {
+            case 'n':
+                match_count = atoi(optarg);
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                thread_count = atoi(optarg);
+                break;
+            case 'c':
+                csv = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n matches] [-s seed] [-t threads] [-c]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (match_count < 1) {
+        fprintf(stderr, "the number of matches must be positive\n");
+        return 1;
+    }
+
+    load_program_policy(argv[0]);
+    settings_t* settings = init_settings();
+    settings_fields_t* settings_fields = init_settings_fields();
+    char** labels = settings_fields->ai_labels;
+    int ai_count = settings_fields->ai_count;
+    // reports[left * ai_count + right] of the current difficulty
+    headless_report_t* reports = (headless_report_t*)malloc(ai_count * ai_count * sizeof(headless_report_t));
+    if (!reports) {
+        fprintf(stderr, "allocation error\n");
+        return 1;
+    }
+
+    if (csv) {
+        printf("difficulty,ai,opponent,wins,losses,draws,win_rate,ci_low,ci_high,hits_per_rally,ticks_per_second\n");
+    } else {
+        printf("%d matches per pairing and side, seed %u, win rates of the first AI with 95%% Wilson intervals\n\n", match_count, seed);
+        printf("%-7s %-16s %6s %6s %5s  %-23s  %7s  %11s\n", "level", "pairing", "wins", "losses", "draws", "win rate", "hits/r", "ticks/s");
+    }
+    int ret = 0;
+    for (int d = 0; d < DIFFICULTY_COUNT && !ret; d++) {
+        settings->difficulty = d;
+        for (int left = 0; left < ai_count && !ret; left++) {
+            for (int right = 0; right < ai_count && !ret; right++) {
+                // the same seeds for every pairing, so the pairings differ only in the AI
+                int ai[2] = {left, right};
+                if (run_headless(settings, ai, seed, match_count, thread_count, NULL, &reports[left * ai_count + right])) ret = 1;
+            }
+        }
+        if (ret) break;
+        // different AIs are summed over both sides of the court, so the side does not matter;
+        // an AI against itself shows the win rate of the left side
+        for (int first = 0; first < ai_count; first++) {
+            for (int second = first; second < ai_count; second++) {
+                headless_report_t* a = &reports[first * ai_count + second];
+                headless_report_t* b = &reports[second * ai_count + first];
+                if (first == second) {
+                    print_row(csv, settings_fields->difficulties[d], labels[first], labels[second], a->wins[0], a->wins[1], a->draws,
+                              a->hits[0] + a->hits[1], a->rallies, a->ticks, a->seconds);
+                } else {
+                    print_row(csv, settings_fields->difficulties[d], labels[first], labels[second], a->wins[0] + b->wins[1],
+                              a->wins[1] + b->wins[0], a->draws + b->draws, a->hits[0] + a->hits[1] + b->hits[0] + b->hits[1],
+                              a->rallies + b->rallies, a->ticks + b->ticks, a->seconds + b->seconds);
+                }
+            }
+        }
+    }
+
+    free(reports);
+    unload_policy();
+    destroy_settings_fields(settings_fields);
+    destroy_settings(settings);
+    return ret;
+}
@@ -0,0 +1,259 @@
+/** @file
+ * Trainer of the learned AI (policy_ai.c). \n
+ * The table imitates a teacher which knows the exact place the ball reaches the paddle (predict_face_y()
+ * of collision.c) and moves the paddle to hit the ball with its middle, or back to the middle of the court while
+ * the ball goes away. The states are collected in the games the table itself plays, with the physics of game.c:
+ * every round plays matches of the learned AI against the smarter AI and against itself at every difficulty, every update
+ * of both paddles is a vote of the teacher for its state, and each state visited so far keeps the move with
+ * the most votes of all rounds. The next round plays the new table, so the table learns to recover from the states
+ * its own mistakes lead to. The first table stands still. \n
+ * The matches are shared by threads on all cpu cores, every match has its own seed, so the table depends only
+ * on the seed and the numbers of rounds and matches. Each round is written to the policy file and mapped like
+ * the game does. At the end the table optionally plays the smarter AI at every difficulty in the headless mode. \n
+ * Usage: trainer [-o file] [-r rounds] [-n matches] [-s seed] [-t threads] [-e matches]
+ */
+
+#define _GNU_SOURCE
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ai_registry.h"
+#include "collision.h"
+#include "game.h"
+#include "headless.h"
+#include "policy_ai.h"
+#include "settings.h"
+#include "tick_scheduler.h"
+
+/**
+ * Work shared by the threads of one round, the threads take the matches one by one.
+ */
+struct train_work {
+    /** the settings of every difficulty */
+    settings_t* settings;
+    unsigned int seed;
+    int first_match;
+    int match_count;
+    int next_match;
+    /** votes[state * 3 + move + 1] of all rounds */
+    int* votes;
+    long long ticks;
+};
+
+void* train_worker(void* arg);
+void play_training_match(struct train_work* work, int match, long long* ticks);
+char teacher_move(char is_right, struct game_data* game_data);
+int update_table(unsigned char* table, int* votes, int* visited);
+int write_policy(char* path, unsigned char* table);
+
+/**
+ * The move of the teacher: towards the paddle position centred on the place the ball reaches the paddle face,
+ * or on the middle of the court if the ball goes away.
+ * @param is_right 0 for the left paddle, 1 for the right one
+ * @param game_data the state of the game
+ * @return -1 for moving up, 0 for not moving, 1 for moving down
+ */
+char teacher_move(char is_right, struct game_data* game_data) {
+    int paddle_y = is_right ? game_data->paddle_right_pos : game_data->paddle_left_pos;
+    int target = LIVES_FONT_SIZE + (LCD_HEIGHT - LIVES_FONT_SIZE) / 2 - PADDLE_HEIGHT / 2;
+    if (is_right ? game_data->ball_vel_x > 0 : game_data->ball_vel_x < 0) {
+        fixed_t at = predict_face_y(game_data->ball_pos_x, game_data->ball_pos_y, game_data->ball_vel_x, game_data->ball_vel_y, NULL);
+        target = FIXED_ROUND(at) - (PADDLE_HEIGHT - BALL_SIZE) / 2;
+    }
+    // a paddle less than one step away stays, it would only jitter around the target
+    if (target <= paddle_y - PADDLE_SPEED_KEY) return -1;
+    if (target >= paddle_y + PADDLE_SPEED_KEY) return 1;
+    return 0;
+}
+
+/**
+ * Play one match of the round and add the votes of the teacher for the states of both paddles.
+ * @param work the work of the round
+ * @param match the index of the match in the round
+ * @param ticks the number of the played updates is added here
+ */
+void play_training_match(struct train_work* work, int match, long long* ticks) {
+    game_ctx_t ctx;
+    struct tick_input no_input;
+    memset(&no_input, 0, sizeof(no_input));
+    init_game_ctx(&ctx, &work->settings[match % DIFFICULTY_COUNT], NULL, match_seed(work->seed, work->first_match + match));
+    ctx.logging = 0;
+    set_game_ai(&ctx, 0, POLICY_AI);
+    set_game_ai(&ctx, 1, match / DIFFICULTY_COUNT % 2 ? SMARTER_AI : POLICY_AI);
+    do {
+        for (int side = 0; side < 2; side++) {
+            int vote = policy_index(side, &ctx.data) * 3 + teacher_move(side, &ctx.data) + 1;
+            __atomic_fetch_add(&work->votes[vote], 1, __ATOMIC_RELAXED);
+        }
+    } while (ctx.stats.ticks < HEADLESS_MAX_TICKS && update(&ctx, no_input));
+    *ticks += ctx.stats.ticks;
+    destroy_game_ctx(&ctx);
+}
+
+/**
+ * Take matches from the shared work until all of them are played.
+ * @param arg pointer to the struct train_work of the round
+ */
+void* train_worker(void* arg) {
+    struct train_work* work = (struct train_work*)arg;
+    long long ticks = 0;
+    int match;
+    while ((match = __atomic_fetch_add(&work->next_match, 1, __ATOMIC_RELAXED)) < work->match_count) {
+        play_training_match(work, match, &ticks);
+    }
+    __atomic_fetch_add(&work->ticks, ticks, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+/**
+ * Set the move of every state with votes to the move with the most votes, a tie keeps the paddle still.
+ * @param table the policy file, header included
+ * @param votes the votes of all rounds
+ * @param visited the number of the states with votes is stored here
+ * @return the number of the changed moves
+ */
+int update_table(unsigned char* table, int* votes, int* visited) {
+    int changed = 0;
+    *visited = 0;
+    for (int i = 0; i < POLICY_STATES; i++) {
+        int* v = &votes[i * 3];
+        if (!v[0] && !v[1] && !v[2]) continue;
+        (*visited)++;
+        signed char move = 0;
+        if (v[0] > v[1] && v[0] > v[2]) move = -1;
+        if (v[2] > v[1] && v[2] > v[0]) move = 1;
+        if ((signed char)table[POLICY_HEADER_SIZE + i] != move) changed++;
+        table[POLICY_HEADER_SIZE + i] = (unsigned char)move;
+    }
+    return changed;
+}
+
+/**
+ * Write the policy file with the checksum of its moves and map it for the learned AI.
+ * @param path the path of the file
+ * @param table the policy file, header included
+ * @return 0 on success, -1 on error
+ */
+int write_policy(char* path, unsigned char* table) {
+    uint32_t checksum = compute_policy_checksum(table);
+    for (int i = 0; i < 4; i++) table[POLICY_CHECKSUM_OFFSET + i] = checksum >> (8 * i);
+    // the new file replaces the old one by rename, so the games which have the old one mapped keep reading it
+    char tmp_path[PATH_MAX];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return -1;
+    }
+    FILE* file = fopen(tmp_path, "wb");
+    size_t written = file ? fwrite(table, 1, POLICY_FILE_SIZE, file) : 0;
+    char flushed = file && !fflush(file);
+    if (!file || fclose(file) || !flushed || written != POLICY_FILE_SIZE || rename(tmp_path, path)) {
+        fprintf(stderr, "cannot write %s\n", path);
+        remove(tmp_path);
+        return -1;
+    }
+    // the written file is played, so a broken file shows up here rather than in the game
+    if (load_policy(path)) {
+        fprintf(stderr, "cannot load %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    char* path = POLICY_FILE;
+    int rounds = 10;
+    int match_count = 150;
+    unsigned int seed = 1;
+    int thread_count = 0;
+    int eval_count = 200;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:r:n:s:t:e:")) != -1) {
+        switch (opt) {
+            case 'o':
+                path = optarg;
+                break;
+            case 'r':
+                rounds = atoi(optarg);
+                break;
+            case 'n':
+                match_count = atoi(optarg);
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                thread_count = atoi(optarg);
+                break;
+            case 'e':
+                eval_count = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-o file] [-r rounds] [-n matches] [-s seed] [-t threads] [-e matches]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (rounds < 1 || match_count < 1 || eval_count < 0) {
+        fprintf(stderr, "the numbers of rounds and matches must be positive\n");
+        return 1;
+    }
+    if (thread_count <= 0) thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (thread_count <= 0) thread_count = 1;
+
+    unsigned char* table = (unsigned char*)calloc(POLICY_FILE_SIZE, 1);
+    int* votes = (int*)calloc(POLICY_STATES * 3, sizeof(int));
+    pthread_t* threads = (pthread_t*)malloc(thread_count * sizeof(pthread_t));
+    if (!table || !votes || !threads) {
+        fprintf(stderr, "allocation error\n");
+        return 1;
+    }
+    fill_policy_header(table);
+    settings_t* settings = init_settings();
+    settings->left = BOT;
+    settings->right = BOT;
+    settings_t difficulties[DIFFICULTY_COUNT];
+    for (int d = 0; d < DIFFICULTY_COUNT; d++) {
+        difficulties[d] = *settings;
+        difficulties[d].difficulty = d;
+    }
+    int ret = write_policy(path, table);
+    printf("%d states, %d rounds of %d matches, seed %u, %d threads\n", POLICY_STATES, rounds, match_count, seed, thread_count);
+    for (int round = 0; round < rounds && !ret; round++) {
+        struct train_work work = {difficulties, seed, round * match_count, match_count, 0, votes, 0};
+        long long start = monotonic_ns();
+        int started = 0;
+        for (; started < thread_count; started++) {
+            if (pthread_create(&threads[started], NULL, train_worker, &work)) break;
+        }
+        // without any thread the matches are played here
+        if (!started) train_worker(&work);
+        for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+        double seconds = (double)(monotonic_ns() - start) / NSEC_PER_SEC;
+        int visited;
+        int changed = update_table(table, votes, &visited);
+        printf("round %-3d visited %6d states, changed %6d, %lld ticks in %.3f s, %.0f ticks/s\n", round, visited, changed,
+               work.ticks, seconds, seconds > 0 ? work.ticks / seconds : 0.0);
+        ret = write_policy(path, table);
+    }
+    free(threads);
+    free(votes);
+    free(table);
+
+    for (int d = 0; d < DIFFICULTY_COUNT && !ret && eval_count; d++) {
+        int ai[2] = {POLICY_AI, SMARTER_AI};
+        headless_report_t report;
+        ret = run_headless(&difficulties[d], ai, seed, eval_count, thread_count, NULL, &report);
+        if (!ret) {
+            char* labels[2] = {get_ai(POLICY_AI)->label, get_ai(SMARTER_AI)->label};
+            printf("\ndifficulty       %d\n", d);
+            print_headless_report(&report, labels);
+        }
+    }
+    unload_policy();
+    destroy_settings(settings);
+    return ret ? 1 : 0;
+}